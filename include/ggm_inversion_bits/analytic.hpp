@@ -28,6 +28,8 @@ SOFTWARE.
 */
 
 #include "solver_base.hpp"
+#include "chol_factor.hpp"
+#include "graph.hpp"
 
 #include <string>
 #include <armadillo>
@@ -41,6 +43,10 @@ std::pair<arma::mat, arma::mat> solve_3d_v1(const arma::mat &cov_mat_true, const
 
 std::pair<arma::mat, arma::mat> solve_no_non_free(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init);
 
+/// Exact solution for a chordal pattern with all diagonal elements free
+/// @details B = sum over cliques C of [S_CC^-1]^0 - sum over separators S of [S_SS^-1]^0, where [.]^0 pads with zeros to the full dim. One pass in O(sum of clique sizes cubed), plus the inverse of B for the cov mat.
+std::pair<arma::mat, arma::mat> solve_chordal(const CliqueTree &clique_tree, const arma::mat &cov_mat_true);
+
 struct AnalyticallySolvable {
     int id;
     int dim;
@@ -55,11 +61,22 @@ bool check_idx_pairs_contains(const std::vector<std::pair<int,int>> &idx_pairs,
 
 std::vector<AnalyticallySolvable> get_analytically_solvable_models(int dim);
 
+/// Result of matching a pattern against the solvable models; cached on the pattern
+struct AnalyticMatch {
+    bool matches = false;
+    AnalyticallySolvable solvable;
+    
+    /// Clique tree if the pattern is solved as a chordal pattern, else null
+    std::shared_ptr<const CliqueTree> clique_tree;
+    
+    AnalyticMatch(const CompiledPattern &pattern);
+};
+
 class AnalyticSolver : public SolverBase {
                     
 private:
     
-    AnalyticallySolvable _solvable;
+    std::shared_ptr<const AnalyticMatch> _match;
     
     /// Internal clean up
     void _clean_up();
@@ -68,11 +85,23 @@ private:
     /// Internal move
     void _move(AnalyticSolver &other);
 
+protected:
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+    /// Also matches the new pattern against the solvable models
+    void _set_pattern(std::shared_ptr<const CompiledPattern> pattern) override;
+    
+    /// Match the pattern against the solvable models, from the cache of the pattern, throwing if none applies
+    void _match_pattern();
+    
 public:
     
+    /// Patterns are matched against the explicit models first, then checked for chordality; throws if neither applies
     AnalyticSolver(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free);
-    
-    std::pair<arma::mat, arma::mat> solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    AnalyticSolver(std::shared_ptr<const CompiledPattern> pattern);
 };
 
 }
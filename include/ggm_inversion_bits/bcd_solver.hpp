@@ -0,0 +1,62 @@
+//
+/*
+File: bcd_solver.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "solver_base.hpp"
+
+#include <string>
+#include <armadillo>
+
+#ifndef BCD_SOLVER_H
+#define BCD_SOLVER_H
+
+namespace ginv {
+
+/// Row-wise block coordinate descent for covariance selection
+/// @details The cov mat W starts at the target. Each sweep regresses every variable on its free neighbours. This takes a linear solve of size equal to the node degree d, and then updates the row and column of W. A sweep costs O(n d^3 + n^2 d). No learning rate is needed, and the iteration converges from the target itself. The prec mat is recovered from the regression coefficients at the end. All diagonal elements must be free.
+class BCDSolver : public SolverBase {
+protected:
+    
+    /// Solve; the initial prec mat is not used, since the sweeps start from the target
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+public:
+    
+    int max_no_sweeps = 1000;
+    
+    /// Converged if the max absolute change in the cov mat over a sweep falls below this
+    double conv_max_abs_diff = 1e-8;
+    
+    using SolverBase::SolverBase;
+};
+
+}
+
+#endif
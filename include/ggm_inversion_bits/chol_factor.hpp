@@ -0,0 +1,73 @@
+//
+/*
+File: chol_factor.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <armadillo>
+
+#ifndef CHOL_FACTOR_H
+#define CHOL_FACTOR_H
+
+namespace ginv {
+
+/// Cholesky factorization of a symmetric PD matrix B = U^T U
+/// @details One factorization per iterate serves as the PD test (the factorization fails iff B is not PD), the inverse and the log-det. The inverse is computed from the factor on first request and cached until the next factorization. Buffers are reused between factorizations of the same size.
+class CholFactor {
+    
+private:
+    
+    arma::mat _chol_mat;
+    mutable arma::mat _inv_mat;
+    mutable bool _inv_valid;
+    mutable bool _is_pd;
+    
+public:
+    
+    CholFactor();
+    
+    /// Factorize a symmetric matrix; only the upper triangle is referenced
+    /// @param mat Matrix
+    /// @return True if PD, else false
+    bool factorize(const arma::mat &mat);
+    
+    /// Whether the last factorized matrix was PD
+    bool is_pd() const;
+    
+    /// Upper triangular factor U
+    const arma::mat& get_chol_mat() const;
+    
+    /// Inverse of the last factorized matrix, computed from the factor and cached
+    /// @details If the inversion fails, is_pd() becomes false and the returned matrix is all NaN.
+    const arma::mat& get_inv() const;
+    
+    /// Log of the determinant of the last factorized matrix
+    double get_log_det() const;
+};
+
+};
+
+#endif
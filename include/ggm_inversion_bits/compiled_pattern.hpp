@@ -0,0 +1,147 @@
+//
+/*
+File: compiled_pattern.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <vector>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <typeindex>
+#include <functional>
+#include <cstdint>
+#include <armadillo>
+
+#ifndef COMPILED_PATTERN_H
+#define COMPILED_PATTERN_H
+
+namespace ginv {
+
+struct SparseCholSymbolic;
+struct NonFreeSlots;
+
+/// Immutable index structure of a free pair pattern, shared between solvers
+/// @details Built once in O(n + F log F), with O(n + F) memory. Pairs are stored structure-of-arrays with the column-major linear offsets of both (i,j) and (j,i), so gather and scatter are tight indexed loops. The O(n^2) tables of the non-free pairs are only built on first use. Pass around as shared_ptr<const CompiledPattern> so that constructing a solver for a known pattern costs almost nothing.
+struct CompiledPattern {
+    
+    int dim;
+    
+    /// Free pairs as given
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    
+    /// Rows, cols and linear offsets of (row,col) and (col,row) for each free slot
+    std::vector<std::int32_t> free_rows, free_cols;
+    std::vector<arma::uword> free_offsets, free_offsets_trans;
+    
+    /// Free slot of each diagonal element; -1 if not free
+    std::vector<std::int32_t> diag_slots;
+    
+    /// Adjacency of the graph of off-diagonal free pairs in CSR form: the neighbours of i are adj_idx[adj_ptr[i]], ..., adj_idx[adj_ptr[i+1]-1], sorted, and adj_slots holds the free slot of each
+    std::vector<std::int32_t> adj_ptr, adj_idx, adj_slots;
+    
+    /// Hash of the dim and the free pairs, in order; does not depend on the orientation of each pair
+    std::size_t hash;
+    
+    CompiledPattern(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free);
+    
+    /// Free slot of (i,j) or (j,i), or -1 if not free
+    /// @details Binary search in the neighbours of i, so O(log deg(i))
+    int get_free_slot(int i, int j) const;
+    
+    /// Whether (i,j) or (j,i) is free
+    bool check_free(int i, int j) const;
+    
+    int get_no_free() const;
+    int get_no_non_free() const;
+    
+    /// Non-free pairs and their offsets, computed on first use and shared by all users of the pattern; thread safe
+    /// @details O(n^2) time and memory, so only used by the solvers that work on dense mats
+    std::shared_ptr<const NonFreeSlots> get_non_free_slots() const;
+    
+    /// Whether another pattern has the same dim and free pairs in the same order, so that vecs over the free elements agree
+    bool check_same(const CompiledPattern &other) const;
+    
+    /// Symbolic sparse Cholesky analysis of the pattern, computed on first use and shared by all users of the pattern; thread safe
+    std::shared_ptr<const SparseCholSymbolic> get_sparse_chol_symbolic() const;
+    
+    /// Data of type T derived from the pattern alone, e.g. the decomposition or the Jacobian structure of a solver, computed on first use and shared by all users of the pattern; thread safe
+    /// @details One entry per type. Concurrent first calls may both build it; the first stored result is kept. build is called without a lock held, so it may use the caches of other patterns.
+    /// @param build Function building the data
+    /// @return Cached data
+    template<typename T>
+    std::shared_ptr<const T> get_derived(const std::function<std::shared_ptr<const T>()> &build) const {
+        std::type_index key(typeid(T));
+        {
+            std::lock_guard<std::mutex> lock(_derived_mutex);
+            auto it = _derived.find(key);
+            if (it != _derived.end()) {
+                return std::static_pointer_cast<const T>(it->second);
+            }
+        }
+        
+        std::shared_ptr<const T> data = build();
+        std::lock_guard<std::mutex> lock(_derived_mutex);
+        auto it = _derived.emplace(key, data).first;
+        return std::static_pointer_cast<const T>(it->second);
+    }
+    
+private:
+    
+    int _no_non_free;
+    
+    mutable std::shared_ptr<const SparseCholSymbolic> _sparse_chol_symbolic;
+    mutable std::shared_ptr<const NonFreeSlots> _non_free_slots;
+    
+    mutable std::mutex _derived_mutex;
+    mutable std::map<std::type_index, std::shared_ptr<const void>> _derived;
+};
+
+/// Non-free pairs of a pattern, i.e. the pairs constrained to zero in the prec mat
+struct NonFreeSlots {
+    
+    /// Non-free pairs (i,j), i <= j, in row-major order
+    std::vector<std::pair<int,int>> idx_pairs_non_free;
+    
+    /// Rows, cols and linear offsets of (row,col) and (col,row) for each non-free slot
+    std::vector<std::int32_t> non_free_rows, non_free_cols;
+    std::vector<arma::uword> non_free_offsets, non_free_offsets_trans;
+    
+    NonFreeSlots(const CompiledPattern &pattern);
+};
+
+/// Compile a free pair pattern
+std::shared_ptr<const CompiledPattern> compile_pattern(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free);
+
+/// Compile the pattern induced on a subset of the vertices, in local indices
+/// @details Costs O(sum of degrees in the subset), not O(F). Pairs are ordered by local row, diagonal first.
+/// @param pattern Full pattern
+/// @param idxs Sorted vertices of the subset; local index k is idxs(k)
+std::shared_ptr<const CompiledPattern> compile_sub_pattern(const CompiledPattern &pattern, const arma::uvec &idxs);
+
+};
+
+#endif
@@ -0,0 +1,90 @@
+//
+/*
+File: graph.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "compiled_pattern.hpp"
+
+#include <vector>
+#include <armadillo>
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+namespace ginv {
+
+/// Clique tree of a chordal graph
+/// @details Cliques are the maximal cliques, in the order found by maximum cardinality search. The separator of a clique is its intersection with its parent. Roots, one per connected component, have parent -1 and an empty separator.
+struct CliqueTree {
+    std::vector<arma::uvec> cliques, separators;
+    std::vector<int> parents;
+};
+
+/// Minimal triangulation H of a graph from MCS-M
+/// @details Labels are the weights of the vertices when visited. adj is the sorted adjacency of H, which contains the graph and the fill edges.
+struct MinimalTriangulation {
+    std::vector<int> order, labels;
+    std::vector<std::vector<int>> adj;
+};
+
+/// Decomposition of a graph by clique minimal separators
+/// @details Atoms are the maximal subgraphs without a clique separator. Each cut of the decomposition adds one separator, and the atoms and separators together form a tree, as for a clique tree. All vertex sets are sorted.
+struct AtomDecomposition {
+    std::vector<arma::uvec> atoms, separators;
+};
+
+/// Maximum cardinality search over the graph of off-diagonal free pairs
+/// @details Buckets with lazy deletion; O(n + m). The reverse of the visit order is a perfect elimination ordering iff the graph is chordal.
+/// @return Vertices in visit order
+std::vector<int> get_mcs_order(const CompiledPattern &pattern);
+
+/// Whether the graph of off-diagonal free pairs is chordal, checked via the perfect elimination ordering of an MCS
+bool check_chordal(const CompiledPattern &pattern, const std::vector<int> &mcs_order);
+
+/// Clique tree of a chordal graph from an MCS (Blair-Peyton)
+CliqueTree get_clique_tree(const CompiledPattern &pattern, const std::vector<int> &mcs_order);
+
+/// Maximal cliques of the graph of off-diagonal free pairs by Bron-Kerbosch with Tomita pivoting
+/// @details Isolated vertices are cliques of size one. Each clique is sorted.
+std::vector<arma::uvec> get_maximal_cliques(const CompiledPattern &pattern);
+
+/// Minimum degree ordering of the graph of off-diagonal free pairs, as a fill-reducing ordering for sparse Cholesky
+/// @details Exact minimum degree on the elimination graph: the vertex of least degree is eliminated and its nbrs are joined into a clique. Ties go to the lowest index. Cost follows the fill, O(sum over eliminated vertices of degree squared), plus O(log n) per degree update for the selection from a heap.
+/// @return Vertices in elimination order
+std::vector<int> get_min_degree_order(const CompiledPattern &pattern);
+
+/// MCS-M minimal triangulation of the graph of off-diagonal free pairs
+/// @details A vertex u gains weight when the visited vertex reaches it through unvisited vertices of lower weight; each such pair not already adjacent is a fill edge. O(n m).
+MinimalTriangulation get_mcs_m(const CompiledPattern &pattern);
+
+/// Decomposition by clique minimal separators with the Atoms algorithm of Berry, Pogorelcnik and Simonet
+/// @details The minimal separators of the MCS-M triangulation are visited in elimination order. Each one that is a clique in the graph cuts off the connected component containing its generator.
+AtomDecomposition get_atoms(const CompiledPattern &pattern);
+
+};
+
+#endif
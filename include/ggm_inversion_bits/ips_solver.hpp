@@ -0,0 +1,62 @@
+//
+/*
+File: ips_solver.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "solver_base.hpp"
+
+#include <string>
+#include <armadillo>
+
+#ifndef IPS_SOLVER_H
+#define IPS_SOLVER_H
+
+namespace ginv {
+
+/// Iterative proportional scaling over the maximal cliques of the graph of free pairs
+/// @details Each clique step sets B_CC += S_CC^-1 - Sigma_CC^-1, which restores the target on the clique exactly. The cov mat is updated along with it by the rank-|C| correction Sigma += Sigma_{:C} Sigma_CC^-1 (S_CC - Sigma_CC) Sigma_CC^-1 Sigma_{C:}. A step costs O(n^2 |C|), and B stays PD without any step size. All diagonal elements must be free.
+class IPSSolver : public SolverBase {
+protected:
+    
+    /// Solve; the initial prec mat is zeroed at the non-free elements, and replaced by diag(1 / S_ii) if that is not PD
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+public:
+    
+    int max_no_sweeps = 1000;
+    
+    /// Converged if the max absolute err of the cov mat on the cliques, each taken just before its step, falls below this over a sweep
+    double conv_max_abs_err = 1e-8;
+    
+    using SolverBase::SolverBase;
+};
+
+}
+
+#endif
@@ -0,0 +1,73 @@
+//
+/*
+File: krylov.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <functional>
+#include <armadillo>
+
+#ifndef KRYLOV_H
+#define KRYLOV_H
+
+namespace ginv {
+
+/// Matrix-free linear operator
+typedef std::function<arma::vec(const arma::vec&)> MatVecProd;
+
+/// Truncated conjugate gradient for A x = b, as used in Newton-CG
+/// @details Stops when the residual norm drops below tol, after max_no_steps, or when negative curvature is encountered. In the latter case, the iterate so far is returned, or b itself if encountered on the first step.
+/// @param mat_vec_prod Product with the symmetric matrix A
+/// @param b Right hand side
+/// @param tol Absolute tolerance on the residual norm
+/// @param max_no_steps Max no CG steps
+/// @return Approximate solution x
+arma::vec solve_cg_truncated(const MatVecProd &mat_vec_prod, const arma::vec &b, double tol, int max_no_steps);
+
+/// Steihaug-Toint CG for the trust region subproblem min_x - b^T x + x^T A x / 2 subject to |x| <= radius
+/// @details CG from x = 0 that stops at the boundary of the trust region if a step would leave it or negative curvature is encountered, and otherwise when the residual norm drops below tol or after max_no_steps.
+/// @param mat_vec_prod Product with the symmetric matrix A
+/// @param b Right hand side, i.e. the negative gradient of the model
+/// @param radius Trust region radius
+/// @param tol Absolute tolerance on the residual norm
+/// @param max_no_steps Max no CG steps
+/// @param on_boundary Set to whether the solution lies on the boundary of the trust region
+/// @return Approximate solution x
+arma::vec solve_cg_steihaug(const MatVecProd &mat_vec_prod, const arma::vec &b, double radius, double tol, int max_no_steps, bool &on_boundary);
+
+/// Restarted GMRES for A x = b, starting from x = 0
+/// @details Arnoldi with modified Gram-Schmidt and Givens rotations; memory is (restart + 1) vectors of the size of b.
+/// @param mat_vec_prod Product with the matrix A
+/// @param b Right hand side
+/// @param tol Absolute tolerance on the residual norm
+/// @param restart Krylov subspace dimension before restarting
+/// @param max_no_steps Max total no products with A
+/// @return Approximate solution x
+arma::vec solve_gmres(const MatVecProd &mat_vec_prod, const arma::vec &b, double tol, int restart, int max_no_steps);
+
+};
+
+#endif
@@ -35,6 +35,12 @@ SOFTWARE.
 namespace ginv {
 
 class L2OptimizerAdam : public L2OptimizerBase {
+protected:
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
 public:
     
     double adam_beta_1 = 0.9;
@@ -43,11 +49,7 @@ public:
     double lr = 1.0;
     int no_opt_steps = 100;
     
-    Options options;
-    
     using L2OptimizerBase::L2OptimizerBase;
-    
-    std::pair<arma::mat, arma::mat> solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
 };
 
 }
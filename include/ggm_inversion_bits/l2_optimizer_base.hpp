@@ -28,6 +28,7 @@ SOFTWARE.
 */
 
 #include "solver_base.hpp"
+#include "chol_factor.hpp"
 
 #include <string>
 #include <armadillo>
@@ -38,15 +39,48 @@ SOFTWARE.
 namespace ginv {
 
 class L2OptimizerBase : public SolverBase {
+
+public:
+    
+    /// Buffers for one solve, allocated once so that steady-state iterations do not allocate
+    struct Workspace {
+        arma::mat res_mat, prod_mat, tmp_mat, derivs, derivs_trial, update_mat, prec_mat_prev;
+        CholFactor chol_factor;
         
+        Workspace(int dim);
+    };
+    
 protected:
         
     double _get_first_deriv_inverse_mat(const arma::mat &cov_mat_curr, int d1, int d2, int n1, int n2) const;
     double _get_second_deriv_inverse_mat(const arma::mat &cov_mat_curr, int d1, int d2, int d3, int d4, int n1, int n2) const;
 
-    void _log_progress_if_needed(Options options, int opt_step, int no_opt_steps, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_targets, const arma::mat &prec_mat_curr) const;
+    /// Factorize the initial prec mat, throwing if it is not PD
+    void _factorize_init(CholFactor &chol_factor, const arma::mat &prec_mat_init) const;
+    
+    /// Residuals of the cov mat at the free elements, times two, stored one-sided
+    void _get_res_mat(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true, arma::mat &res_mat) const;
+    
+    /// Gather - (P + P^T) at the free elements, with the diagonal counted once
+    void _gather_deriv_mat(const arma::mat &prod_mat, arma::mat &derivs) const;
+    
+    /// Allocation-free line search along workspace.update_mat from workspace.prec_mat_prev, rejecting steps that are not PD
+    /// @details Armijo backtracking, or with the curvature condition, bisection between the largest step known to satisfy it and the smallest known to violate the Armijo condition or leave the PD cone.
+    /// @param cov_mat_true Target cov mat
+    /// @param obj_func_0 Obj func at workspace.prec_mat_prev
+    /// @param slope Directional deriv along workspace.update_mat; must be negative
+    /// @param step_size_init First trial step
+    /// @param armijo_c Armijo condition constant
+    /// @param wolfe_c Curvature condition constant; <= 0 for Armijo backtracking only
+    /// @param max_no_backtracks Max no trial steps
+    /// @param prec_mat_curr Accepted iterate, with workspace.chol_factor factorizing it; workspace.prec_mat_prev if none
+    /// @param workspace Workspace; workspace.derivs_trial is overwritten
+    /// @return Step size, or zero if no acceptable step was found
+    double _get_step_size_line_search(const arma::mat &cov_mat_true, double obj_func_0, double slope, double step_size_init, double armijo_c, double wolfe_c, int max_no_backtracks, arma::mat &prec_mat_curr, Workspace &workspace) const;
+
+    void _log_progress_if_needed(const Options &options, int opt_step, int no_opt_steps, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_targets, const arma::mat &prec_mat_curr) const;
     
-    void _write_progress_if_needed(Options options, int opt_step, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const;
+    void _write_progress_if_needed(const Options &options, int opt_step, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const;
     
 private:
     
@@ -65,10 +99,46 @@ public:
     
     double get_obj_func_val(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const;
     
+    /// Derivatives of the obj func wrt the free elements of the prec mat
+    /// @details Computed as - Sigma * R * Sigma gathered at the free elements, where R holds the residuals; O(n^3)
+    /// @param cov_mat_curr Current cov mat = inverse of the current prec mat
+    /// @param cov_mat_true Target cov mat
+    /// @return Symmetric matrix of derivs, zero at the non-free elements
     arma::mat get_deriv_mat(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const;
+    
+    /// Allocation-free version of get_deriv_mat using the buffers of a workspace
+    void get_deriv_mat(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true, arma::mat &derivs, Workspace &workspace) const;
+    
+    /// Reference element-wise implementation of get_deriv_mat; O(F^2) where F is the no. free elements
+    arma::mat get_deriv_mat_reference(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const;
     arma::vec get_deriv_vec(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const;
 
     arma::mat get_hessian(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const;
+    
+    /// Product of the Hessian with a vector of free elements, without forming the Hessian; O(n^3)
+    /// @param cov_mat_curr Current cov mat = inverse of the current prec mat
+    /// @param cov_mat_true Target cov mat
+    /// @param vec Vector in the space of free elements
+    /// @return Hessian times vec
+    arma::vec get_hessian_vec_prod(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true, const arma::vec &vec) const;
+    
+    /// Jacobian of the residuals Sigma - S at the free elements wrt the free elements of the prec mat
+    /// @details Entry (k, s) is d Sigma_k / d B_s from _get_first_deriv_inverse_mat, so the derivs are 2 J^T r for residuals r; O(F^2)
+    /// @param cov_mat_curr Current cov mat = inverse of the current prec mat
+    /// @return F x F Jacobian
+    arma::mat get_res_jacobian(const arma::mat &cov_mat_curr) const;
+    
+    /// Product of the residual Jacobian with a vector of free elements, as - Sigma * D * Sigma gathered at the free elements; O(n^3)
+    /// @param cov_mat_curr Current cov mat = inverse of the current prec mat
+    /// @param vec Vector in the space of free elements
+    /// @return J times vec
+    arma::vec get_res_jacobian_vec_prod(const arma::mat &cov_mat_curr, const arma::vec &vec) const;
+    
+    /// Product of the transposed residual Jacobian with a vector of residuals, by the same kernel as get_deriv_mat; O(n^3)
+    /// @param cov_mat_curr Current cov mat = inverse of the current prec mat
+    /// @param vec Vector in the space of free elements
+    /// @return J^T times vec
+    arma::vec get_res_jacobian_trans_vec_prod(const arma::mat &cov_mat_curr, const arma::vec &vec) const;
 };
 
 }
@@ -29,21 +29,42 @@ SOFTWARE.
 
 #include "l2_optimizer_base.hpp"
 
+#include <string>
+
 #ifndef OPTIMIZER_SGD_H
 #define OPTIMIZER_SGD_H
 
 namespace ginv {
 
+/// Gradient descent on the L2 loss
+/// @details By default, fixed steps of size lr, stopping at the last PD iterate. With a line search, the step size adapts each iteration: the trial step starts at twice the last accepted one, and steps that are not PD are rejected, so the iterates stay in the PD cone. The line search works in the buffers of the workspace and does not allocate.
 class L2OptimizerGD : public L2OptimizerBase {
+protected:
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
 public:
     
+    /// Step size; with a line search, the first trial step
     double lr = 1.0;
     int no_opt_steps = 100;
-    Options options;
+    
+    /// Line search: "none" for fixed steps of size lr, "armijo" or "wolfe"
+    std::string line_search = "none";
+    
+    double armijo_c = 1e-4;
+    
+    /// Curvature condition constant for "wolfe"
+    double wolfe_c = 0.9;
+    
+    int max_no_backtracks = 50;
+    
+    /// With a line search, converged if the max absolute deriv falls below this
+    double conv_max_abs_deriv = 1e-10;
     
     using L2OptimizerBase::L2OptimizerBase;
-        
-    std::pair<arma::mat, arma::mat> solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
 };
 
 }
@@ -0,0 +1,89 @@
+//
+/*
+File: l2_optimizer_lbfgs.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "l2_optimizer_base.hpp"
+
+#ifndef OPTIMIZER_LBFGS_H
+#define OPTIMIZER_LBFGS_H
+
+namespace ginv {
+
+/// L-BFGS minimization of the L2 loss
+/// @details The search direction comes from the two-loop recursion over the last history_size pairs (s, y) of changes in the free elements of B and in the derivs, kept in ring buffers. Pairs with s^T y <= 0 are skipped so that the inverse Hessian approximation stays PD. Steps come from a Wolfe line search that rejects steps leaving the PD cone. All buffers live in thread-local workspaces keyed by the dim, no free elements and history size, so repeated solves, e.g. in a batch or over the components of a pattern, do not allocate beyond the returned mats. Each thread keeps at most max_no_cached_workspaces of them, evicting the least recently used.
+class L2OptimizerLBFGS : public L2OptimizerBase {
+    
+public:
+    
+    /// Buffers for a solve, including the ring buffers of the history
+    struct LBFGSWorkspace : public Workspace {
+        int dim, no_free, history_size;
+        
+        /// Pair k is col k of s_vecs and y_vecs, with rhos(k) = 1 / s^T y
+        arma::mat s_vecs, y_vecs;
+        arma::vec rhos, alphas;
+        arma::vec deriv_vec, deriv_vec_prev, prec_vec, prec_vec_prev, update_vec;
+        
+        LBFGSWorkspace(int dim, int no_free, int history_size);
+    };
+    
+protected:
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+    /// Thread-local workspace of the right sizes, from the cache of the thread
+    LBFGSWorkspace& _get_workspace() const;
+    
+public:
+    
+    /// Max no workspaces of different sizes cached per thread
+    static const size_t max_no_cached_workspaces = 8;
+    
+    int no_opt_steps = 100;
+    
+    /// No (s, y) pairs kept
+    int history_size = 10;
+    
+    double armijo_c = 1e-4;
+    
+    /// Curvature condition constant
+    double wolfe_c = 0.9;
+    
+    int max_no_backtracks = 50;
+    
+    /// Converged if the max absolute deriv falls below this
+    double conv_max_abs_deriv = 1e-10;
+    
+    using L2OptimizerBase::L2OptimizerBase;
+};
+
+}
+
+#endif
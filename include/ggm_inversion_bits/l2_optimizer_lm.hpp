@@ -0,0 +1,73 @@
+//
+/*
+File: l2_optimizer_lm.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "l2_optimizer_base.hpp"
+
+#ifndef OPTIMIZER_LM_H
+#define OPTIMIZER_LM_H
+
+namespace ginv {
+
+/// Levenberg-Marquardt minimization of the L2 loss
+/// @details The loss is |r|^2 for the residuals r = Sigma - S at the free elements, with Jacobian J = d r / d B at the free elements. Each step solves the damped Gauss-Newton system (J^T J + lambda I) d = - J^T r, which needs only first derivs of the inverse. J^T J is formed if the no free elements is at most max_no_free_dense, else the system is solved by CG on products with J and J^T. The damping adapts to the ratio of the actual to the predicted reduction (Nielsen's rule), and steps leaving the PD cone are rejected like steps with no reduction.
+class L2OptimizerLM : public L2OptimizerBase {
+protected:
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+public:
+    
+    int no_opt_steps = 100;
+    
+    /// Initial damping, relative to max(diag(Sigma))^4 at the initial prec mat, a lower bound on the max diagonal element of J^T J
+    double init_lambda_rel = 1e-3;
+    
+    /// Stop if the damping grows beyond this, relative as for init_lambda_rel
+    double max_lambda_rel = 1e16;
+    
+    /// Form J^T J if the no free elements is at most this, else use CG on products with J and J^T
+    int max_no_free_dense = 500;
+    
+    /// Max no CG steps per step
+    int cg_max_no_steps = 100;
+    
+    /// Max relative CG tolerance; the forcing term is min(cg_max_rel_tol, sqrt(|g| / |g_0|)) for gradient g
+    double cg_max_rel_tol = 0.5;
+    
+    /// Converged if the max absolute deriv falls below this
+    double conv_max_abs_deriv = 1e-10;
+    
+    using L2OptimizerBase::L2OptimizerBase;
+};
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+//
+/*
+File: l2_optimizer_newton_cg.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "l2_optimizer_base.hpp"
+
+#ifndef OPTIMIZER_NEWTON_CG_H
+#define OPTIMIZER_NEWTON_CG_H
+
+namespace ginv {
+
+/// Newton-CG minimization of the L2 loss
+/// @details Each Newton system is solved approximately by truncated CG on Hessian-vector products, so the Hessian is never formed. Steps are globalized by an Armijo backtracking line search that also rejects steps leaving the PD cone.
+class L2OptimizerNewtonCG : public L2OptimizerBase {
+protected:
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+public:
+    
+    int no_opt_steps = 100;
+    
+    /// Max no CG steps per Newton step
+    int cg_max_no_steps = 100;
+    
+    /// Max relative CG tolerance; the forcing term is min(cg_max_rel_tol, sqrt(|g| / |g_0|)) for gradient g
+    double cg_max_rel_tol = 0.5;
+    
+    /// Converged if the max absolute deriv falls below this
+    double conv_max_abs_deriv = 1e-10;
+    
+    double armijo_c = 1e-4;
+    int max_no_backtracks = 50;
+    
+    using L2OptimizerBase::L2OptimizerBase;
+};
+
+}
+
+#endif
@@ -54,6 +54,15 @@ private:
     
     OptimAlg _alg;
     
+protected:
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+    /// The optim settings are written during a solve
+    bool _supports_concurrent_solves() const override;
+    
 public:
     
     bool log_result = true;
@@ -66,8 +75,6 @@ public:
     void set_alg_cg(double lr);
 
     using L2OptimizerBase::L2OptimizerBase;
-
-    std::pair<arma::mat, arma::mat> solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
 };
 
 }
@@ -0,0 +1,78 @@
+//
+/*
+File: l2_optimizer_trust_region.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "l2_optimizer_base.hpp"
+
+#ifndef OPTIMIZER_TRUST_REGION_H
+#define OPTIMIZER_TRUST_REGION_H
+
+namespace ginv {
+
+/// Trust region Newton minimization of the L2 loss
+/// @details Each step minimizes the quadratic model of the loss within a ball of the free elements by Steihaug-Toint CG. The Hessian is formed by get_hessian if the no free elements is at most max_no_free_hessian, else only Hessian-vector products are used. A step is accepted if the ratio of the actual to the predicted reduction of the obj func exceeds accept_ratio; the radius shrinks if the ratio is small and grows if it is large and the step reached the boundary. Steps leaving the PD cone are rejected like steps with no reduction.
+class L2OptimizerTrustRegion : public L2OptimizerBase {
+protected:
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+public:
+    
+    int no_opt_steps = 100;
+    
+    /// Initial radius; if <= 0, a tenth of the norm of the free elements of the initial prec mat
+    double init_radius = 0.0;
+    
+    double max_radius = 1e10;
+    
+    /// Stop if the radius falls below this times the norm of the free elements of the prec mat
+    double min_rel_radius = 1e-14;
+    
+    /// Min ratio of actual to predicted reduction to accept a step
+    double accept_ratio = 0.1;
+    
+    /// Form the Hessian if the no free elements is at most this, else use Hessian-vector products
+    int max_no_free_hessian = 100;
+    
+    /// Max no CG steps per subproblem
+    int cg_max_no_steps = 100;
+    
+    /// Max relative CG tolerance; the forcing term is min(cg_max_rel_tol, sqrt(|g| / |g_0|)) for gradient g
+    double cg_max_rel_tol = 0.5;
+    
+    /// Converged if the max absolute deriv falls below this
+    double conv_max_abs_deriv = 1e-10;
+    
+    using L2OptimizerBase::L2OptimizerBase;
+};
+
+}
+
+#endif
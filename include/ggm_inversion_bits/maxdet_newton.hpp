@@ -0,0 +1,101 @@
+//
+/*
+File: maxdet_newton.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "solver_base.hpp"
+#include "chol_factor.hpp"
+#include "sparse_chol_factor.hpp"
+
+#include <string>
+#include <armadillo>
+
+#ifndef MAXDET_NEWTON_H
+#define MAXDET_NEWTON_H
+
+namespace ginv {
+
+/// Newton-CG on the max-determinant completion
+/// @details Minimizes f(B) = - log det B + tr(S B) over the free elements of B. The gradient is S - Sigma at the free elements, counted twice off the diagonal. The Hessian-vector product is the same gather of Sigma dB Sigma. Each Newton system is solved by CG, and the step backtracks until the Cholesky factorization succeeds and the Armijo condition holds, so every iterate is PD. All diagonal elements must be free.
+class MaxDetNewton : public SolverBase {
+protected:
+    
+    /// Solve; the initial prec mat is zeroed at the non-free elements, and replaced by diag(1 / S_ii) if that is not PD
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+    /// Gather a symmetric mat at the free elements, with the off-diagonal elements counted twice
+    void _gather_sym(const arma::mat &mat, arma::vec &vec) const;
+    
+public:
+    
+    int max_no_opt_steps = 100;
+    
+    /// Max no CG steps per Newton step
+    int cg_max_no_steps = 200;
+    
+    /// Max relative CG tolerance; the forcing term is min(cg_max_rel_tol, sqrt(|g| / |g_0|)) for gradient g
+    double cg_max_rel_tol = 0.5;
+    
+    /// Converged if the max absolute err of the cov mat at the free elements falls below this
+    double conv_max_abs_err = 1e-8;
+    
+    double armijo_c = 1e-4;
+    int max_no_backtracks = 50;
+    
+    using SolverBase::SolverBase;
+    
+    /// Objective - log det B + tr(S B) for a factorized prec mat B
+    double get_obj_func_val(const CholFactor &chol_factor, const arma::mat &prec_mat, const arma::mat &cov_mat_true) const;
+    
+    /// Gradient S - Sigma at the free elements, off-diagonal elements counted twice
+    arma::vec get_deriv_vec(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const;
+    
+    /// Hessian-vector product: gather of Sigma dB Sigma for dB = free_vec_to_mat(vec)
+    arma::vec get_hessian_vec_prod(const arma::mat &cov_mat_curr, const arma::vec &vec) const;
+    
+    /// Solve with the prec mat stored sparse throughout
+    /// @details Same iteration as solve(), but the prec mat is kept as a vec over the free elements and factorized by SparseCholFactor with a minimum degree ordering, so memory is O(n + F + nnz(L)) and no dense n x n mat is formed: the pattern only stores the free pairs and their adjacency, and its O(n^2) tables of the non-free pairs are never built on this path. Sigma is only needed at the free elements, and comes from selected inversion of the factor; each Hessian-vector product costs two sparse solves per col. The pattern is solved as a whole, without the component and atom decompositions of solve().
+    /// @param cov_mat_true Target cov mat; only the free elements are read
+    /// @param prec_mat_init Initial prec mat; elements outside the pattern are ignored. If empty or not PD, diag(1 / S_ii) is used
+    /// @return Cov mat restricted to the pattern, and the prec mat
+    std::pair<arma::sp_mat, arma::sp_mat> solve_sparse(const arma::sp_mat &cov_mat_true, const arma::sp_mat &prec_mat_init) const;
+    
+    /// Objective - log det B + tr(S B) from a sparse factorization, with B and S given at the free elements
+    double get_obj_func_val(const SparseCholFactor &chol_factor, const arma::vec &prec_vec, const arma::vec &cov_vec_true) const;
+    
+    /// Sigma = B^-1 at the free elements from a sparse factorization of B, by selected inversion
+    arma::vec get_cov_vec(const SparseCholFactor &chol_factor) const;
+    
+    /// Hessian-vector product from a sparse factorization, without forming Sigma
+    arma::vec get_hessian_vec_prod(const SparseCholFactor &chol_factor, const arma::vec &vec) const;
+};
+
+}
+
+#endif
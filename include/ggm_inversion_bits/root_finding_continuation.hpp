@@ -0,0 +1,76 @@
+//
+/*
+File: root_finding_continuation.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "root_finding_newton.hpp"
+
+#include <armadillo>
+
+#ifndef ROOT_FINDING_CONTINUATION_H
+#define ROOT_FINDING_CONTINUATION_H
+
+namespace ginv {
+
+/// Newton root finding along a homotopy from the diagonal of the target to the full target
+/// @details The free elements of Sigma follow S(t) = diag(S) + t (S - diag(S)) for t from 0 to 1. At t = 0 the solution is B = diag(1 / S_ii), Sigma = diag(S). Each step factorizes the dense Jacobian once by LU, takes a tangent predictor, and runs a few chord corrector steps with the same factorization. A step is accepted if the corrector converges, contracts and leaves B PD; then the step size grows. Otherwise it is halved. At t = 1, Newton steps continue until the convergence criteria of RootFindingNewton are met. The initial prec mat is not used. All diagonal elements must be free.
+class RootFindingContinuation : public RootFindingNewton {
+    
+protected:
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+    /// Add an update vec (free elements of B, then non-free elements of Sigma)
+    void _apply_update(const arma::vec &update_vec, double step_size, arma::mat &prec_mat_curr, arma::mat &cov_mat_curr) const;
+    
+    /// Set the free elements of Sigma from a vec over the free elements
+    void _set_free_cov(const arma::vec &cov_vec, arma::mat &cov_mat_curr) const;
+    
+public:
+    
+    double init_step_size = 0.1;
+    double min_step_size = 1e-6;
+    
+    /// Factor by which the step size grows after an accepted step
+    double step_size_growth = 2.0;
+    
+    int max_no_continuation_steps = 1000;
+    
+    /// Max no chord corrector steps per continuation step
+    int max_no_corrector_steps = 4;
+    
+    /// Corrector converged if the max absolute residual falls below this
+    double corrector_max_abs_res = 1e-4;
+    
+    using RootFindingNewton::RootFindingNewton;
+};
+
+}
+
+#endif
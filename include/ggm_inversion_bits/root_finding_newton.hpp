@@ -28,8 +28,11 @@ SOFTWARE.
 */
 
 #include "solver_base.hpp"
+#include "chol_factor.hpp"
 
 #include <string>
+#include <memory>
+#include <atomic>
 #include <armadillo>
 
 #ifndef NEWTONS_METHOD_H
@@ -37,15 +40,86 @@ SOFTWARE.
 
 namespace ginv {
 
+/// Sparsity structure of the Newton Jacobian for a free pair pattern
+/// @details Locations are sorted in column-major order. Columns wrt the free elements of B take their values from the cov mat at idxs_cov, columns wrt the non-free elements of Sigma from the prec mat at idxs_prec.
+struct JacStructure {
+    arma::umat locations;
+    arma::uvec idxs_cov, idxs_prec;
+};
+
+/// Counters of the work done by RootFindingNewton solves; thread safe, so one may be shared by the clones solving components and by batches
+struct RootFindingNewtonStats {
+    
+    /// No Newton steps taken
+    std::atomic<long> no_opt_steps{0};
+    
+    /// No Jacobians solved by a direct factorization, fresh or reused; zero in the Jacobian-free mode
+    std::atomic<long> no_jacobian_factorizations{0};
+};
+
 class RootFindingNewton : public SolverBase {
+
+public:
+    
+    /// Buffers for one solve, allocated once so that the bookkeeping around each Newton step does not allocate
+    struct Workspace {
+        arma::mat prod_mat, update_mat_b, update_mat_sigma, prec_mat_trial, cov_mat_trial;
+        arma::vec residuals, residuals_trial, residuals_prev, update_vec, step_vec;
+        CholFactor chol_factor;
+        
+        Workspace(int dim, int no_dofs);
+    };
         
 protected:
-            
-    bool _check_convergence(Options options, int opt_step, int no_opt_steps, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const;
     
-    void _log_progress_if_needed(Options options, int opt_step, int no_opt_steps, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_targets, const arma::mat &prec_mat_curr) const;
+    /// Dense LU factorization of the Jacobian, P^T L U = J
+    struct LUFactor {
+        arma::mat l_mat, u_mat, p_mat;
+    };
+    
+    std::pair<arma::mat, arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const override;
+    
+    bool _check_convergence(const Options &options, int opt_step, int no_opt_steps, const arma::vec &residuals) const;
+    
+    void _log_progress_if_needed(const Options &options, int opt_step, int no_opt_steps, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_targets, const arma::mat &prec_mat_curr) const;
+    
+    void _write_progress_if_needed(const Options &options, int opt_step, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const;
+    
+    /// Jacobian structure, cached on the pattern on first use so that the Jacobian-free mode never pays for it and clones share it
+    std::shared_ptr<const JacStructure> _get_jac_structure() const;
+    std::shared_ptr<const JacStructure> _build_jac_structure() const;
+    
+    /// Eisenstat-Walker forcing term for the inexact Newton step
+    double _get_forcing_term(int opt_step, double res_norm, double res_norm_prev, double forcing_term_prev) const;
     
-    void _write_progress_if_needed(Options options, int opt_step, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const;
+    /// Assemble the Jacobian, sparse if use_sparse_jacobian, and factorize it by dense LU
+    /// @return False if the Jacobian is singular
+    bool _factorize_jacobian(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, LUFactor &lu_factor) const;
+    void _solve_lu(const LUFactor &lu_factor, const arma::vec &rhs, arma::vec &update_vec) const;
+    
+    /// Solve with the inverse Jacobian approximation (I + u_{k-1} s_{k-1}^T) ... (I + u_0 s_0^T) J_0^{-1} from good Broyden updates in product form; O(m^2 + k m)
+    /// @param lu_factor Factor of J_0
+    /// @param s_vecs Steps s_j in the first no_updates cols
+    /// @param u_vecs Update vecs u_j = (s_j - H_j y_j) / (s_j^T H_j y_j) in the first no_updates cols
+    /// @param no_updates No rank-one updates k
+    /// @param rhs Right hand side
+    /// @param update_vec Solution
+    void _solve_lu_broyden(const LUFactor &lu_factor, const arma::mat &s_vecs, const arma::mat &u_vecs, int no_updates, const arma::vec &rhs, arma::vec &update_vec) const;
+    
+    /// Backtracking line search along workspace.update_mat_b and workspace.update_mat_sigma on the residual norm, rejecting steps where B is not PD
+    /// @details Accepts the first step size a in 1, 1/2, ... with |F(a)| <= (1 - armijo_c * a * (1 - eta)) |F(0)|, the sufficient decrease condition for an inexact Newton step with forcing term eta.
+    /// @param prec_mat_curr Current prec mat
+    /// @param cov_mat_curr Current cov mat
+    /// @param res_norm Current residual norm
+    /// @param eta Forcing term of the Newton step; zero for an exact step
+    /// @param workspace Workspace; the trial buffers are overwritten
+    /// @return Step size, or zero if no acceptable step was found
+    double _get_step_size_merit(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, double res_norm, double eta, Workspace &workspace) const;
+    
+    /// Index of (i,j), i <= j, in upper_tri_to_vec
+    int _get_upper_tri_idx(int i, int j) const;
     
 private:
     
@@ -61,17 +135,63 @@ public:
     double conv_max_abs_res = 0.01;
     double conv_mean_abs_res = 0.01;
     int conv_max_no_opt_steps = 100;
-    Options options;
+    
+    /// Assemble the Jacobian in sparse form and solve with a sparse direct solver
+    bool use_sparse_jacobian = true;
+    
+    /// Solver passed to arma::spsolve: "superlu" or "lapack" (dense fallback)
+#ifdef ARMA_USE_SUPERLU
+    std::string sparse_solver = "superlu";
+#else
+    std::string sparse_solver = "lapack";
+#endif
+    
+    /// Jacobian-free Newton-Krylov: solve each Newton step with GMRES on Jacobian-vector products
+    /// @details The Jacobian is never formed; memory is O(n^2) instead of O(n^4). Steps are inexact with Eisenstat-Walker forcing terms.
+    bool use_jacobian_free = false;
+    int gmres_restart = 30;
+    int gmres_max_no_steps = 300;
+    
+    /// Jacobian refresh policy for the direct solvers
+    /// @details "always": factorize the Jacobian at every step. "shamanskii": reuse the LU factor of the Jacobian for up to jacobian_refresh_interval steps. "broyden": as "shamanskii", but with a good Broyden rank-one update of the inverse after each step. With reuse, most steps cost O(m^2) for m unknowns instead of O(m^3). The factor is always dense, so use_sparse_jacobian only affects the assembly. Ignored if use_jacobian_free.
+    std::string jacobian_refresh = "always";
+    int jacobian_refresh_interval = 5;
+    
+    /// Refresh early if the residual norm contracts by less than this factor per step
+    double max_contraction_ratio = 0.5;
+    
+    /// Globalize by a backtracking line search on the residual norm that also rejects steps where B is not PD
+    /// @details The initial prec mat must then be PD, but need not be close to the solution.
+    bool globalized = false;
+    double armijo_c = 1e-4;
+    int max_no_backtracks = 30;
+    
+    /// Opt-in counters of the work done, which are shared with the clones solving components and atoms; null to disable
+    std::shared_ptr<RootFindingNewtonStats> stats;
+    
+    /// Eisenstat-Walker (choice 2) parameters
+    double ew_forcing_max = 0.9;
+    double ew_gamma = 0.9;
+    double ew_alpha = 2.0;
     
     using SolverBase::SolverBase;
     
     arma::mat get_i_mat(int k, int l) const;
     arma::vec upper_tri_to_vec(const arma::mat &mat) const;
+    void upper_tri_to_vec(const arma::mat &mat, arma::vec &vec) const;
     
     arma::vec get_residuals(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const;
+    
+    /// Allocation-free version of get_residuals; prod_mat is scratch space
+    void get_residuals(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, arma::vec &residuals, arma::mat &prod_mat) const;
     arma::mat get_jacobian(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const;
-
-    std::pair<arma::mat,arma::mat> solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const override;
+    
+    /// Jacobian assembled directly in sparse form from the cached structure; each column has O(n) non-zeros
+    arma::sp_mat get_jacobian_sparse(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const;
+    
+    /// Product of the Jacobian with a vector (free elements of B, then non-free elements of Sigma)
+    /// @details Computed as upper_tri(dB * Sigma + B * dSigma); two n x n products
+    arma::vec get_jacobian_vec_prod(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, const arma::vec &vec) const;
 };
 
 }
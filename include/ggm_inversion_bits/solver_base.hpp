@@ -28,8 +28,12 @@ SOFTWARE.
 */
 
 #include "options.hpp"
+#include "compiled_pattern.hpp"
+#include "graph.hpp"
+#include "warm_start_cache.hpp"
 
 #include <string>
+#include <memory>
 #include <armadillo>
 
 #ifndef SOLVER_BASE_H
@@ -37,22 +41,65 @@ SOFTWARE.
 
 namespace ginv {
 
+/// Decomposition of a pattern into connected components used by SolverBase, with the sub-patterns in local indices; cached on the pattern, so the sub-patterns and their own caches are shared by all solves
+struct PatternDecomposition {
+    
+    /// Connected components of the graph of off-diagonal free pairs, and their patterns; empty if connected
+    std::vector<arma::uvec> components;
+    std::vector<std::shared_ptr<const CompiledPattern>> component_patterns;
+    
+    PatternDecomposition(const CompiledPattern &pattern);
+};
+
+/// Decomposition of a connected pattern with free diagonal by clique minimal separators; cached on the pattern, and only built if decompose_separators is set
+struct PatternAtoms {
+    
+    /// Atoms and separators, and the patterns of the atoms; null for complete atoms. Empty if there is a single atom, or the diagonal is not free
+    AtomDecomposition atom_decomposition;
+    std::vector<std::shared_ptr<const CompiledPattern>> atom_patterns;
+    
+    /// @param pattern Connected pattern
+    PatternAtoms(const CompiledPattern &pattern);
+};
+
 class SolverBase {
         
 protected:
     
-    std::vector<std::pair<int,int>> _idx_pairs_free, _idx_pairs_non_free;
+    std::shared_ptr<const CompiledPattern> _pattern;
     int _dim;
+    
+    /// Components of the pattern, from the cache of the pattern; atoms are fetched when needed
+    std::shared_ptr<const PatternDecomposition> _decomposition;
+    
+    /// Solve, decomposing into components and atoms if enabled
+    std::pair<arma::mat,arma::mat> _solve_decomposed(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const;
+    
+    /// Solve for the pattern of this solver; called by solve() for each connected component
+    virtual std::pair<arma::mat,arma::mat> _solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const = 0;
+    
+    /// Copy of this solver, with all settings, for another pattern
+    virtual std::shared_ptr<SolverBase> _clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const = 0;
+    
+    /// Switch to another pattern; subclasses with per-pattern state must reset it, preferably from the cache of the pattern so that clones stay cheap
+    virtual void _set_pattern(std::shared_ptr<const CompiledPattern> pattern);
+    
+    /// Solve each connected component with a clone of this solver, and scatter into the full mats
+    std::pair<arma::mat,arma::mat> _solve_components(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const;
+    
+    /// Solve each atom with a clone of this solver, or directly if complete, and glue: B = sum over atoms of B_A - sum over separators of S_SS^-1
+    std::pair<arma::mat,arma::mat> _solve_atoms(const PatternAtoms &pattern_atoms, const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const;
 
     std::string _get_log_header(std::string header, int opt_step, int max_no_opt_steps) const;
     std::string _get_log_header(const Options &options, int opt_step, int max_no_opt_steps) const;
     void _log_mat_info(const arma::mat &mat, const Options &options, int opt_step, int max_no_opt_steps) const;
     void _log_mat_info(const arma::mat &mat, std::string header) const;
+    
+    /// Whether solve() may be called concurrently on the same object
+    virtual bool _supports_concurrent_solves() const;
 
 private:
     
-    bool _check_pair_exists(const std::vector<std::pair<int,int>> &pairs, std::pair<int,int> pr_search) const;
-    
     /// Internal clean up
     void _clean_up();
     /// Internal copy
@@ -64,7 +111,25 @@ public:
     
     std::string log_header="";
     
+    Options options;
+    
+    /// Solve the connected components of the pattern independently; the prec mat is block diagonal over them
+    bool decompose_components = true;
+    
+    /// Within a connected component with free diagonal, solve the atoms left by clique minimal separators independently and glue them exactly
+    /// @details Off by default, so that the solver sees each connected component whole, with its progress logged and written as one problem. The atoms are only computed, once per pattern, by the first solve with this set
+    bool decompose_separators = false;
+    
+    /// No threads for the components and atoms; <= 0 to use the hardware concurrency
+    /// @details Ignored, i.e. serial, when the solve itself runs inside solve_batch or another parallel_for
+    int no_threads_components = 0;
+    
+    /// Opt-in cache of previous solutions, which may be shared between solvers; null to disable
+    /// @details If set, solve() starts from the cached solution of the nearest previous target on the same pattern in place of prec_mat_init, if one is within the max distance of the cache and positive definite, and adds its own solution to the cache if positive definite. Components and atoms are not cached separately.
+    std::shared_ptr<WarmStartCache> warm_start_cache;
+    
     SolverBase(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free);
+    SolverBase(std::shared_ptr<const CompiledPattern> pattern);
     SolverBase(const SolverBase& other);
     SolverBase& operator=(const SolverBase& other);
     SolverBase(SolverBase&& other);
@@ -72,6 +137,7 @@ public:
     virtual ~SolverBase();
     
     std::vector<std::pair<int,int>> get_idx_pairs_free() const;
+    std::shared_ptr<const CompiledPattern> get_pattern() const;
     int get_dim() const;
     
     arma::mat free_vec_to_mat(const arma::vec &vec) const;
@@ -81,8 +147,39 @@ public:
 
     arma::mat zero_free_elements(const arma::mat &mat) const;
     arma::mat zero_non_free_elements(const arma::mat &mat) const;
-
-    virtual std::pair<arma::mat,arma::mat> solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const = 0;
+    
+    // Out-parameter versions of the conversions; these do not allocate if the output already has the right size
+    void free_vec_to_mat(const arma::vec &vec, arma::mat &mat) const;
+    void non_free_vec_to_mat(const arma::vec &vec, arma::mat &mat) const;
+    void free_mat_to_vec(const arma::mat &mat, arma::vec &vec) const;
+    void non_free_mat_to_vec(const arma::mat &mat, arma::vec &vec) const;
+    
+    void zero_free_elements(const arma::mat &mat, arma::mat &out) const;
+    void zero_non_free_elements(const arma::mat &mat, arma::mat &out) const;
+    
+    /// Sparse mat with the free elements of vec at both (i,j) and (j,i); O(F) memory
+    arma::sp_mat free_vec_to_sp_mat(const arma::vec &vec) const;
+    
+    /// Free elements of a sparse mat; elements outside the pattern are ignored
+    arma::vec free_sp_mat_to_vec(const arma::sp_mat &mat) const;
+
+    /// Solve for the cov mat and prec mat
+    /// @details If the graph of off-diagonal free pairs is not connected, each component is solved independently and in parallel by a copy of this solver. Components of a single free diagonal element are solved directly. Progress of component i is logged with a [Block i] header and written to write_dir + "block_i/". If decompose_separators is set, a connected pattern with free diagonal is further split at separators whose pairs are all free; the atoms are solved in the same way, with complete atoms inverted directly and progress logged with an [Atom i] header.
+    /// @param cov_mat_true Target cov mat
+    /// @param prec_mat_init Initial prec mat
+    /// @return (cov mat, prec mat)
+    std::pair<arma::mat,arma::mat> solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const;
+    
+    /// Solve many targets sharing this free pair pattern on a work-stealing thread pool
+    /// @details All items share this solver, and so any per-pattern precomputation. The components and atoms of each item are then solved serially, since the batch already occupies the threads. Writing progress to files is not supported, since all items would write to the same files.
+    /// @param cov_mats_true Target cov mats
+    /// @param prec_mat_init Initial prec mat used for every target
+    /// @param no_threads No threads; <= 0 to use the hardware concurrency
+    /// @return (cov mat, prec mat) solution for each target, in order
+    std::vector<std::pair<arma::mat,arma::mat>> solve_batch(const std::vector<arma::mat> &cov_mats_true, const arma::mat &prec_mat_init, int no_threads=0) const;
+    
+    /// Solve many targets sharing this free pair pattern, with one initial prec mat per target
+    std::vector<std::pair<arma::mat,arma::mat>> solve_batch(const std::vector<arma::mat> &cov_mats_true, const std::vector<arma::mat> &prec_mats_init, int no_threads=0) const;
 };
 
 }
@@ -0,0 +1,136 @@
+//
+/*
+File: sparse_chol_factor.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "compiled_pattern.hpp"
+
+#include <vector>
+#include <memory>
+#include <armadillo>
+
+#ifndef SPARSE_CHOL_FACTOR_H
+#define SPARSE_CHOL_FACTOR_H
+
+namespace ginv {
+
+/// Symbolic analysis of sparse Cholesky P B P^T = L L^T for a free pair pattern
+/// @details Depends only on the pattern, so it is built once per CompiledPattern (see CompiledPattern::get_sparse_chol_symbolic) and shared by every SparseCholFactor on it, across iterations, targets and solver copies. Consists of a minimum degree ordering, the elimination tree, the column counts and row indices of L, and the fundamental supernodes. All diagonal elements must be free.
+struct SparseCholSymbolic {
+    
+    int dim;
+    
+    /// Fill-reducing permutation: row k of the permuted mat is row perm[k]; perm_inv is the inverse
+    std::vector<int> perm, perm_inv;
+    
+    /// Elimination tree of the permuted mat; -1 for roots
+    std::vector<int> parent;
+    
+    /// Upper triangle of the pattern of the permuted mat in CSC form
+    std::vector<int> col_ptrs_c, row_idxs_c;
+    
+    /// Pattern of L in CSC form: no nonzeros in each col, and the rows of each col, sorted, diagonal first
+    std::vector<int> col_counts, col_ptrs_l, row_idxs_l;
+    
+    /// Fundamental supernodes: cols super_ptrs[k], ..., super_ptrs[k+1]-1 form a chain in the etree with nested patterns
+    std::vector<int> super_ptrs;
+    
+    SparseCholSymbolic(const CompiledPattern &pattern);
+    
+    int get_no_supernodes() const;
+    
+    /// Nonzero pattern of row k of L, in topological order, in stack[top, ..., dim-1]
+    /// @param marks Work space of size dim; marks[i] == k marks node i as visited
+    /// @param next Work space of size dim
+    /// @return top
+    int ereach(int k, std::vector<int> &stack, std::vector<int> &marks, std::vector<int> &next) const;
+};
+
+/// Sparse Cholesky factorization P B P^T = L L^T of a symmetric PD matrix supported on a free pair pattern
+/// @details The symbolic analysis is shared from the pattern, so a numeric factorization is the only per-iteration cost. Numeric factorization is up-looking, one row of L at a time, as in CSparse. Storage and cost follow the fill of L rather than n^2 and n^3. Elements outside the pattern are ignored.
+class SparseCholFactor {
+    
+private:
+    
+    bool _is_pd;
+    
+    std::shared_ptr<const SparseCholSymbolic> _symbolic;
+    
+    /// Values of L, laid out as SparseCholSymbolic::row_idxs_l
+    std::vector<double> _vals_l;
+    
+    /// Work space; _col_fill is the next free slot in each col of L during factorization
+    std::vector<int> _stack, _marks, _next, _col_fill;
+    std::vector<double> _work;
+    
+    /// Index into the values of L of row i of col j of the permuted mat, i >= j, or -1 if not in the pattern of L
+    int _get_l_idx(int i, int j) const;
+    
+public:
+    
+    SparseCholFactor();
+    
+    /// Use the cached symbolic analysis of a pattern, computing it if this is the first use
+    void analyze(const CompiledPattern &pattern);
+    
+    /// Use a given symbolic analysis
+    void analyze(std::shared_ptr<const SparseCholSymbolic> symbolic);
+    
+    std::shared_ptr<const SparseCholSymbolic> get_symbolic() const;
+    
+    /// Numeric factorization; analyze must have been called for the pattern of the mat
+    /// @param mat Symmetric mat
+    /// @return True if PD, else false
+    bool factorize(const arma::sp_mat &mat);
+    
+    /// Whether the last factorized matrix was PD
+    bool is_pd() const;
+    
+    /// No nonzeros in L
+    int get_no_nonzeros() const;
+    
+    /// Log of the determinant of the last factorized matrix
+    double get_log_det() const;
+    
+    /// Solve B x = b in place
+    void solve_in_place(arma::vec &vec) const;
+    
+    /// Solve B x = b
+    arma::vec solve(const arma::vec &vec) const;
+    
+    /// Selected inversion: the elements of B^-1 on the pattern of L, by the Takahashi recurrences
+    /// @details Cols are visited right to left; each element of col j of the inverse is a combination of elements of later cols on the pattern of col j of L, which is closed under this by the clique property of the filled graph. Costs O(sum over cols of no nonzeros squared) time and O(nnz(L)) memory. The pattern of L contains all free pairs.
+    /// @param vals Elements of P B^-1 P^T, laid out as SparseCholSymbolic::row_idxs_l
+    void get_selected_inv(std::vector<double> &vals) const;
+    
+    /// Element (i,j) of B^-1 from a selected inverse, in the original indices; (i,j) must be in the pattern of L, e.g. a free pair
+    double get_selected_inv_elem(const std::vector<double> &vals, int i, int j) const;
+};
+
+};
+
+#endif
@@ -0,0 +1,51 @@
+//
+/*
+File: thread_pool.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <functional>
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+namespace ginv {
+
+/// Get the no threads to use
+/// @param no_threads Requested no threads; <= 0 to use the hardware concurrency
+/// @return No threads, at least one
+int get_no_threads(int no_threads);
+
+/// Run func(i) for i = 0, ..., no_items-1 on a persistent work-stealing pool
+/// @details The pool is created on first use and its threads are reused by later calls, so a call only pays for waking them. Items are split into contiguous ranges, one per thread, and the calling thread takes part. A thread that runs out of work steals the back half of the largest remaining range of another thread, so items with very different costs do not leave cores idle. A call made from inside func, e.g. a solver that parallelizes its components inside solve_batch, runs serially on the calling thread instead of oversubscribing the cores. The first exception thrown by func stops the remaining items and is rethrown on the calling thread.
+/// @param no_items No items
+/// @param no_threads No threads; <= 0 to use the hardware concurrency
+/// @param func Function to call for each item
+void parallel_for(int no_items, int no_threads, const std::function<void(int)> &func);
+
+};
+
+#endif
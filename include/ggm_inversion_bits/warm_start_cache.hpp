@@ -0,0 +1,114 @@
+//
+/*
+File: warm_start_cache.hpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "compiled_pattern.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <limits>
+#include <unordered_map>
+#include <armadillo>
+
+#ifndef WARM_START_CACHE_H
+#define WARM_START_CACHE_H
+
+namespace ginv {
+
+/// In-process cache of previous solutions, to warm start solves on targets close to ones already solved
+/// @details Entries are grouped by pattern, keyed by the pattern hash and checked for equality. Within a pattern, the targets at the free elements are indexed by a k-d tree, so the nearest previous target is found without a linear scan. New entries go to an unindexed tail that is scanned directly, and the tree is rebuilt when the tail grows past a quarter of the indexed entries. Only the free elements of each solution are stored. All methods are thread safe.
+class WarmStartCache {
+    
+private:
+    
+    struct _Entry {
+        arma::vec cov_vec_true;
+        arma::vec prec_vec;
+    };
+    
+    struct _KdNode {
+        int entry, split_dim, left, right;
+        double split_val;
+    };
+    
+    struct _Bucket {
+        std::shared_ptr<const CompiledPattern> pattern;
+        std::vector<_Entry> entries;
+        
+        /// Tree over entries 0, ..., no_indexed-1; the rest are scanned directly
+        std::vector<_KdNode> nodes;
+        int root = -1;
+        int no_indexed = 0;
+    };
+    
+    mutable std::mutex _mutex;
+    std::unordered_map<std::size_t, std::vector<_Bucket>> _buckets;
+    
+    _Bucket* _find_bucket(const CompiledPattern &pattern);
+    const _Bucket* _find_bucket(const CompiledPattern &pattern) const;
+    
+    /// Build a balanced tree over idxs[lo, ..., hi-1], splitting on the coordinate of largest spread
+    int _build(_Bucket &bucket, std::vector<int> &idxs, int lo, int hi);
+    void _rebuild(_Bucket &bucket);
+    
+    void _search(const _Bucket &bucket, int node, const arma::vec &cov_vec_true, int &best, double &best_dist_sq) const;
+    
+public:
+    
+    /// Max no entries per pattern; beyond this, the oldest half is dropped
+    int max_no_entries_per_pattern = 1000;
+    
+    /// Max Euclidean distance between targets at the free elements for a cached solution to be used
+    double max_dist = std::numeric_limits<double>::infinity();
+    
+    WarmStartCache();
+    
+    /// Nearest cached solution for a target
+    /// @param pattern Pattern
+    /// @param cov_vec_true Target at the free elements of the pattern
+    /// @param prec_mat Solution of the nearest cached target, zero outside the pattern
+    /// @param dist Distance to the nearest cached target
+    /// @return True if a cached target within max_dist was found, else false
+    bool lookup(const CompiledPattern &pattern, const arma::vec &cov_vec_true, arma::mat &prec_mat, double &dist) const;
+    
+    /// Add a solution
+    /// @param pattern Pattern
+    /// @param cov_vec_true Target at the free elements of the pattern
+    /// @param prec_mat Solution
+    void insert(std::shared_ptr<const CompiledPattern> pattern, const arma::vec &cov_vec_true, const arma::mat &prec_mat);
+    
+    /// No entries over all patterns
+    int get_no_entries() const;
+    
+    void clear();
+};
+
+};
+
+#endif
@@ -106,22 +106,52 @@ bool AnalyticallySolvable::check_matches(int dim_other, const std::vector<std::p
     return true;
 }
 
-AnalyticSolver::AnalyticSolver(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free) : SolverBase(dim, idx_pairs_free) {
-    
+AnalyticSolver::AnalyticSolver(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free) : AnalyticSolver(compile_pattern(dim, idx_pairs_free)) {
+}
+
+AnalyticSolver::AnalyticSolver(std::shared_ptr<const CompiledPattern> pattern) : SolverBase(pattern) {
+    _match_pattern();
+}
+
+void AnalyticSolver::_set_pattern(std::shared_ptr<const CompiledPattern> pattern) {
+    SolverBase::_set_pattern(pattern);
+    _match_pattern();
+}
+
+AnalyticMatch::AnalyticMatch(const CompiledPattern &pattern) {
+    int dim = pattern.dim;
     auto solvable_models = get_analytically_solvable_models(dim);
     
     // Check
-    bool matches = false;
     for (auto const &solvable_model: solvable_models) {
-        bool matches_this = solvable_model.check_matches(dim, idx_pairs_free);
-        if (matches_this) {
-            _solvable = solvable_model;
+        if (solvable_model.check_matches(dim, pattern.idx_pairs_free)) {
+            solvable = solvable_model;
             matches = true;
-            break;
+            return;
         }
     }
     
-    if (!matches) {
+    // Any chordal pattern with free diagonal
+    bool diag_free = true;
+    for (auto i=0; i<dim; i++) {
+        diag_free = diag_free && pattern.check_free(i, i);
+    }
+    
+    if (diag_free) {
+        std::vector<int> mcs_order = get_mcs_order(pattern);
+        if (check_chordal(pattern, mcs_order)) {
+            clique_tree = std::make_shared<const CliqueTree>(get_clique_tree(pattern, mcs_order));
+            matches = true;
+        }
+    }
+}
+
+void AnalyticSolver::_match_pattern() {
+    _match = _pattern->get_derived<AnalyticMatch>([&] {
+        return std::make_shared<const AnalyticMatch>(*_pattern);
+    });
+    
+    if (!_match->matches) {
         throw std::invalid_argument("Given model is not supported by the analytic solver!");
     }
 }
@@ -159,12 +189,59 @@ std::pair<arma::mat, arma::mat> solve_3d_v1(const arma::mat &cov_mat_true, const
 
 std::pair<arma::mat, arma::mat> solve_no_non_free(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) {
     arma::mat cov_mat_soln = cov_mat_true;
-    arma::mat prec_mat_soln = arma::inv(cov_mat_soln);
+    
+    CholFactor chol_factor;
+    if (!chol_factor.factorize(cov_mat_soln)) {
+        throw std::invalid_argument("Target cov mat is not positive definite!");
+    }
+    arma::mat prec_mat_soln = chol_factor.get_inv();
+    
     return std::make_pair(cov_mat_soln, prec_mat_soln);
 }
 
-std::pair<arma::mat, arma::mat> AnalyticSolver::solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
-    return (*_solvable.solve)(cov_mat_true, prec_mat_init);
+std::pair<arma::mat, arma::mat> solve_chordal(const CliqueTree &clique_tree, const arma::mat &cov_mat_true) {
+    
+    int dim = cov_mat_true.n_rows;
+    arma::mat prec_mat_soln = arma::zeros(dim,dim);
+    
+    CholFactor chol_factor;
+    for (auto const &clique: clique_tree.cliques) {
+        if (!chol_factor.factorize(cov_mat_true.submat(clique, clique))) {
+            throw std::invalid_argument("Target cov mat is not positive definite on a clique!");
+        }
+        prec_mat_soln.submat(clique, clique) += chol_factor.get_inv();
+    }
+    
+    for (auto const &separator: clique_tree.separators) {
+        if (separator.n_elem == 0) {
+            continue;
+        }
+        if (!chol_factor.factorize(cov_mat_true.submat(separator, separator))) {
+            throw std::invalid_argument("Target cov mat is not positive definite on a separator!");
+        }
+        prec_mat_soln.submat(separator, separator) -= chol_factor.get_inv();
+    }
+    
+    // The completion is PD iff every clique block is
+    if (!chol_factor.factorize(prec_mat_soln)) {
+        throw std::invalid_argument("Assembled prec mat is not positive definite!");
+    }
+    arma::mat cov_mat_soln = chol_factor.get_inv();
+    
+    return std::make_pair(cov_mat_soln, prec_mat_soln);
+}
+
+std::shared_ptr<SolverBase> AnalyticSolver::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<AnalyticSolver> solver = std::make_shared<AnalyticSolver>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat, arma::mat> AnalyticSolver::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    if (_match->clique_tree) {
+        return solve_chordal(*_match->clique_tree, cov_mat_true);
+    }
+    return (*_match->solvable.solve)(cov_mat_true, prec_mat_init);
 }
 
 };
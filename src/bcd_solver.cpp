@@ -0,0 +1,143 @@
+//
+/*
+File: bcd_solver.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/bcd_solver.hpp"
+#include "../include/ggm_inversion_bits/helpers.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace ginv {
+
+std::shared_ptr<SolverBase> BCDSolver::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<BCDSolver> solver = std::make_shared<BCDSolver>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat, arma::mat> BCDSolver::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    for (auto i=0; i<_dim; i++) {
+        if (!_pattern->check_free(i, i)) {
+            throw std::invalid_argument("BCDSolver requires all diagonal elements to be free");
+        }
+    }
+    
+    const std::vector<std::int32_t> &adj_ptr = _pattern->adj_ptr;
+    const std::vector<std::int32_t> &adj_idx = _pattern->adj_idx;
+    
+    // Neighbours of each node
+    std::vector<arma::uvec> nbrs(_dim);
+    for (auto j=0; j<_dim; j++) {
+        nbrs[j].set_size(adj_ptr[j+1] - adj_ptr[j]);
+        for (auto s=adj_ptr[j]; s<adj_ptr[j+1]; s++) {
+            nbrs[j](s - adj_ptr[j]) = adj_idx[s];
+        }
+    }
+    
+    // Start from the target; non-free elements are overwritten in the first sweep
+    arma::mat cov_mat_curr = cov_mat_true;
+    
+    // Regression coefficients of a node on its neighbours
+    arma::vec beta, cov_col;
+    for (auto sweep=0; sweep<max_no_sweeps; sweep++) {
+        
+        double max_abs_diff = 0.0;
+        bool solved = true;
+        for (auto j=0; j<_dim && solved; j++) {
+            const arma::uvec &nbr = nbrs[j];
+            
+            if (nbr.n_elem == 0) {
+                // Isolated node: its row is zero apart from the diagonal
+                cov_col.zeros(_dim);
+            } else {
+                // Regress on the neighbours: W_nn beta = S_nj
+                arma::vec cov_true_nbr = cov_mat_true.elem(nbr + j * _dim);
+                solved = arma::solve(beta, cov_mat_curr.submat(nbr, nbr), cov_true_nbr, arma::solve_opts::likely_sympd);
+                if (!solved) {
+                    break;
+                }
+                
+                // New off-diagonal col: W_{:,nbr} beta; entry j is not used
+                cov_col = cov_mat_curr.cols(nbr) * beta;
+            }
+            cov_col(j) = cov_mat_true(j,j);
+            
+            max_abs_diff = std::max(max_abs_diff, arma::abs(cov_col - cov_mat_curr.col(j)).max());
+            cov_mat_curr.col(j) = cov_col;
+            cov_mat_curr.row(j) = cov_col.t();
+        }
+        
+        if (!solved) {
+            if (options.log_progress) {
+                spdlog::warn(_get_log_header(options, sweep, max_no_sweeps) + "Stopping: cov mat restricted to a neighbourhood is singular");
+            }
+            break;
+        }
+        
+        // Log
+        if (options.log_progress && sweep % options.log_interval == 0) {
+            spdlog::info(_get_log_header(options, sweep, max_no_sweeps) + "max abs change in cov mat: {:e}", max_abs_diff);
+        }
+        
+        // Write
+        if (options.write_progress && sweep % options.write_interval == 0) {
+            assert (options.write_dir != "");
+            write_mat(options.write_dir + "cov_mat.txt", sweep, sweep!=0, cov_mat_curr);
+        }
+        
+        if (max_abs_diff < conv_max_abs_diff) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, sweep, max_no_sweeps) + "Converged: max abs change in cov mat: {:e} is less than limit: {:e}", max_abs_diff, conv_max_abs_diff);
+            }
+            break;
+        }
+    }
+    
+    // Recover the prec mat from the final cov mat: B_jj = 1 / (S_jj - W_jn beta), B_nj = - beta B_jj
+    arma::mat prec_mat_curr = arma::zeros(_dim, _dim);
+    for (auto j=0; j<_dim; j++) {
+        const arma::uvec &nbr = nbrs[j];
+        if (nbr.n_elem == 0) {
+            prec_mat_curr(j,j) = 1.0 / cov_mat_true(j,j);
+        } else {
+            arma::vec cov_nbr = cov_mat_curr.elem(nbr + j * _dim);
+            beta = arma::solve(cov_mat_curr.submat(nbr, nbr), cov_nbr, arma::solve_opts::likely_sympd);
+            double prec_jj = 1.0 / (cov_mat_true(j,j) - arma::dot(cov_nbr, beta));
+            prec_mat_curr(j,j) = prec_jj;
+            prec_mat_curr.elem(nbr + j * _dim) = - prec_jj * beta;
+        }
+    }
+    
+    // Each off-diagonal element is estimated from both of its ends
+    prec_mat_curr = 0.5 * (prec_mat_curr + prec_mat_curr.t());
+    
+    return std::make_pair(cov_mat_curr, prec_mat_curr);
+}
+
+}
@@ -0,0 +1,131 @@
+//
+/*
+File: chol_factor.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/chol_factor.hpp"
+
+// potrf and potri are called through arma::lapack, Armadillo's internal LAPACK wrappers, which are not public API. They have the same signatures in Armadillo 9 and later; check them when raising the supported version range.
+#if !defined(ARMA_USE_LAPACK)
+#error "CholFactor requires Armadillo with LAPACK (ARMA_USE_LAPACK)"
+#endif
+#if ARMA_VERSION_MAJOR < 9
+#error "CholFactor requires Armadillo 9 or later for the arma::lapack wrappers"
+#endif
+
+namespace ginv {
+
+CholFactor::CholFactor() {
+    _inv_valid = false;
+    _is_pd = false;
+}
+
+bool CholFactor::factorize(const arma::mat &mat) {
+    assert(mat.n_rows == mat.n_cols);
+    
+    // Copy into the existing buffer
+    _chol_mat = mat;
+    _inv_valid = false;
+    
+    if (_chol_mat.n_rows == 0) {
+        _is_pd = true;
+        return _is_pd;
+    }
+    
+    // Factorize in place
+    char uplo = 'U';
+    arma::blas_int n = _chol_mat.n_rows;
+    arma::blas_int info = 0;
+    arma::lapack::potrf(&uplo, &n, _chol_mat.memptr(), &n, &info);
+    _is_pd = (info == 0);
+    
+    if (_is_pd) {
+        // Clear the lower triangle, which still holds the input
+        for (arma::uword j=0; j<_chol_mat.n_cols; j++) {
+            for (arma::uword i=j+1; i<_chol_mat.n_rows; i++) {
+                _chol_mat(i,j) = 0.0;
+            }
+        }
+    }
+    
+    return _is_pd;
+}
+
+bool CholFactor::is_pd() const {
+    return _is_pd;
+}
+
+const arma::mat& CholFactor::get_chol_mat() const {
+    assert(_is_pd);
+    return _chol_mat;
+}
+
+const arma::mat& CholFactor::get_inv() const {
+    assert(_is_pd);
+    
+    if (!_inv_valid) {
+        _inv_mat = _chol_mat;
+        
+        if (_inv_mat.n_rows > 0) {
+            char uplo = 'U';
+            arma::blas_int n = _inv_mat.n_rows;
+            arma::blas_int info = 0;
+            arma::lapack::potri(&uplo, &n, _inv_mat.memptr(), &n, &info);
+            
+            // Failure means a zero on the diagonal of the factor; treat like a failed factorization
+            if (info != 0) {
+                _is_pd = false;
+                _inv_mat.fill(arma::datum::nan);
+                return _inv_mat;
+            }
+            
+            // Only the upper triangle is written; symmetrize
+            for (arma::uword j=0; j<_inv_mat.n_cols; j++) {
+                for (arma::uword i=j+1; i<_inv_mat.n_rows; i++) {
+                    _inv_mat(i,j) = _inv_mat(j,i);
+                }
+            }
+        }
+        
+        _inv_valid = true;
+    }
+    
+    return _inv_mat;
+}
+
+double CholFactor::get_log_det() const {
+    assert(_is_pd);
+    
+    double log_det = 0.0;
+    for (arma::uword i=0; i<_chol_mat.n_rows; i++) {
+        log_det += 2.0 * log(_chol_mat(i,i));
+    }
+    
+    return log_det;
+}
+
+};
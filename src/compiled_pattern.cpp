@@ -0,0 +1,228 @@
+//
+/*
+File: compiled_pattern.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/compiled_pattern.hpp"
+#include "../include/ggm_inversion_bits/sparse_chol_factor.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace ginv {
+
+CompiledPattern::CompiledPattern(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free) {
+    this->dim = dim;
+    this->idx_pairs_free = idx_pairs_free;
+    
+    // Free slots
+    diag_slots.assign(dim, -1);
+    adj_ptr.assign(dim + 1, 0);
+    free_rows.reserve(idx_pairs_free.size());
+    free_cols.reserve(idx_pairs_free.size());
+    free_offsets.reserve(idx_pairs_free.size());
+    free_offsets_trans.reserve(idx_pairs_free.size());
+    for (size_t s=0; s<idx_pairs_free.size(); s++) {
+        int i = idx_pairs_free.at(s).first;
+        int j = idx_pairs_free.at(s).second;
+        assert(i >= 0 && i < dim);
+        assert(j >= 0 && j < dim);
+        
+        free_rows.push_back(i);
+        free_cols.push_back(j);
+        free_offsets.push_back((arma::uword)i + (arma::uword)j * dim);
+        free_offsets_trans.push_back((arma::uword)j + (arma::uword)i * dim);
+        
+        if (i == j) {
+            // First occurrence wins for duplicates
+            if (diag_slots[i] < 0) {
+                diag_slots[i] = s;
+            }
+        } else {
+            adj_ptr[i+1]++;
+            adj_ptr[j+1]++;
+        }
+    }
+    
+    // Adjacency: count, then fill both directions, then sort each row
+    for (auto i=0; i<dim; i++) {
+        adj_ptr[i+1] += adj_ptr[i];
+    }
+    std::vector<std::pair<std::int32_t,std::int32_t>> nbrs(adj_ptr[dim]);
+    std::vector<std::int32_t> pos(adj_ptr.begin(), adj_ptr.end() - 1);
+    for (size_t s=0; s<free_rows.size(); s++) {
+        int i = free_rows[s];
+        int j = free_cols[s];
+        if (i != j) {
+            nbrs[pos[i]++] = std::make_pair(j, s);
+            nbrs[pos[j]++] = std::make_pair(i, s);
+        }
+    }
+    
+    // Duplicates are adjacent after sorting by (nbr, slot), so the first occurrence wins
+    adj_idx.reserve(nbrs.size());
+    adj_slots.reserve(nbrs.size());
+    int no_free_distinct = 0;
+    for (auto i=0; i<dim; i++) {
+        std::sort(nbrs.begin() + adj_ptr[i], nbrs.begin() + adj_ptr[i+1]);
+        int begin = adj_idx.size();
+        for (auto s=adj_ptr[i]; s<adj_ptr[i+1]; s++) {
+            if (adj_idx.size() > (size_t)begin && adj_idx.back() == nbrs[s].first) {
+                continue;
+            }
+            adj_idx.push_back(nbrs[s].first);
+            adj_slots.push_back(nbrs[s].second);
+            if (nbrs[s].first > i) {
+                no_free_distinct++;
+            }
+        }
+        adj_ptr[i] = begin;
+        if (diag_slots[i] >= 0) {
+            no_free_distinct++;
+        }
+    }
+    adj_ptr[dim] = adj_idx.size();
+    _no_non_free = dim * (dim + 1) / 2 - no_free_distinct;
+    
+    // Hash of the pairs as (min, max)
+    hash = std::hash<int>()(dim);
+    for (size_t s=0; s<free_rows.size(); s++) {
+        std::size_t h = std::hash<int>()(std::min(free_rows[s], free_cols[s])) * 31 + std::hash<int>()(std::max(free_rows[s], free_cols[s]));
+        hash ^= h + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    }
+}
+
+int CompiledPattern::get_free_slot(int i, int j) const {
+    if (i == j) {
+        return diag_slots[i];
+    }
+    auto begin = adj_idx.begin() + adj_ptr[i];
+    auto end = adj_idx.begin() + adj_ptr[i+1];
+    auto it = std::lower_bound(begin, end, j);
+    if (it == end || *it != j) {
+        return -1;
+    }
+    return adj_slots[it - adj_idx.begin()];
+}
+
+bool CompiledPattern::check_free(int i, int j) const {
+    return get_free_slot(i, j) >= 0;
+}
+
+int CompiledPattern::get_no_free() const {
+    return free_rows.size();
+}
+
+int CompiledPattern::get_no_non_free() const {
+    return _no_non_free;
+}
+
+std::shared_ptr<const NonFreeSlots> CompiledPattern::get_non_free_slots() const {
+    std::shared_ptr<const NonFreeSlots> non_free_slots = std::atomic_load(&_non_free_slots);
+    if (!non_free_slots) {
+        // Concurrent first calls may both build it; either result is identical
+        non_free_slots = std::make_shared<const NonFreeSlots>(*this);
+        std::atomic_store(&_non_free_slots, non_free_slots);
+    }
+    return non_free_slots;
+}
+
+bool CompiledPattern::check_same(const CompiledPattern &other) const {
+    if (dim != other.dim || hash != other.hash || free_rows.size() != other.free_rows.size()) {
+        return false;
+    }
+    for (size_t s=0; s<free_rows.size(); s++) {
+        if (std::min(free_rows[s], free_cols[s]) != std::min(other.free_rows[s], other.free_cols[s]) || std::max(free_rows[s], free_cols[s]) != std::max(other.free_rows[s], other.free_cols[s])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::shared_ptr<const SparseCholSymbolic> CompiledPattern::get_sparse_chol_symbolic() const {
+    std::shared_ptr<const SparseCholSymbolic> symbolic = std::atomic_load(&_sparse_chol_symbolic);
+    if (!symbolic) {
+        // Concurrent first calls may both build it; either result is identical
+        symbolic = std::make_shared<const SparseCholSymbolic>(*this);
+        std::atomic_store(&_sparse_chol_symbolic, symbolic);
+    }
+    return symbolic;
+}
+
+NonFreeSlots::NonFreeSlots(const CompiledPattern &pattern) {
+    int dim = pattern.dim;
+    idx_pairs_non_free.reserve(pattern.get_no_non_free());
+    
+    // Walk the sorted nbrs of each row alongside j
+    for (auto i=0; i<dim; i++) {
+        int s = pattern.adj_ptr[i];
+        for (auto j=i; j<dim; j++) {
+            while (s < pattern.adj_ptr[i+1] && pattern.adj_idx[s] < j) {
+                s++;
+            }
+            bool is_free = (i == j) ? (pattern.diag_slots[i] >= 0) : (s < pattern.adj_ptr[i+1] && pattern.adj_idx[s] == j);
+            if (!is_free) {
+                idx_pairs_non_free.push_back(std::make_pair(i,j));
+                non_free_rows.push_back(i);
+                non_free_cols.push_back(j);
+                non_free_offsets.push_back((arma::uword)i + (arma::uword)j * dim);
+                non_free_offsets_trans.push_back((arma::uword)j + (arma::uword)i * dim);
+            }
+        }
+    }
+}
+
+std::shared_ptr<const CompiledPattern> compile_pattern(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free) {
+    return std::make_shared<const CompiledPattern>(dim, idx_pairs_free);
+}
+
+std::shared_ptr<const CompiledPattern> compile_sub_pattern(const CompiledPattern &pattern, const arma::uvec &idxs) {
+    
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    for (arma::uword k=0; k<idxs.n_elem; k++) {
+        int v = idxs(k);
+        if (pattern.check_free(v, v)) {
+            idx_pairs_free.push_back(std::make_pair(k, k));
+        }
+        
+        // Nbrs after v in the subset, found by binary search
+        for (auto s=pattern.adj_ptr[v]; s<pattern.adj_ptr[v+1]; s++) {
+            arma::uword u = pattern.adj_idx[s];
+            if (u <= (arma::uword)v) {
+                continue;
+            }
+            const arma::uword *it = std::lower_bound(idxs.begin() + k + 1, idxs.end(), u);
+            if (it != idxs.end() && *it == u) {
+                idx_pairs_free.push_back(std::make_pair(k, it - idxs.begin()));
+            }
+        }
+    }
+    
+    return compile_pattern(idxs.n_elem, idx_pairs_free);
+}
+
+};
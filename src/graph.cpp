@@ -0,0 +1,468 @@
+//
+/*
+File: graph.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/graph.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <queue>
+#include <functional>
+
+namespace ginv {
+
+std::vector<int> get_mcs_order(const CompiledPattern &pattern) {
+    int dim = pattern.dim;
+    const std::vector<std::int32_t> &adj_ptr = pattern.adj_ptr;
+    const std::vector<std::int32_t> &adj_idx = pattern.adj_idx;
+    
+    // Buckets by no visited nbrs; stale entries are skipped when popped
+    std::vector<int> weights(dim, 0);
+    std::vector<bool> visited(dim, false);
+    std::vector<std::vector<int>> buckets(dim + 1);
+    for (auto v=dim-1; v>=0; v--) {
+        buckets[0].push_back(v);
+    }
+    
+    std::vector<int> mcs_order;
+    mcs_order.reserve(dim);
+    int weight_max = 0;
+    while ((int)mcs_order.size() < dim) {
+        
+        // Pop the unvisited vertex with the most visited nbrs
+        int v = -1;
+        while (v < 0) {
+            if (buckets[weight_max].empty()) {
+                weight_max--;
+                continue;
+            }
+            int u = buckets[weight_max].back();
+            buckets[weight_max].pop_back();
+            if (!visited[u] && weights[u] == weight_max) {
+                v = u;
+            }
+        }
+        
+        visited[v] = true;
+        mcs_order.push_back(v);
+        
+        for (auto s=adj_ptr[v]; s<adj_ptr[v+1]; s++) {
+            int u = adj_idx[s];
+            if (!visited[u]) {
+                weights[u]++;
+                buckets[weights[u]].push_back(u);
+                weight_max = std::max(weight_max, weights[u]);
+            }
+        }
+    }
+    
+    return mcs_order;
+}
+
+bool check_chordal(const CompiledPattern &pattern, const std::vector<int> &mcs_order) {
+    int dim = pattern.dim;
+    const std::vector<std::int32_t> &adj_ptr = pattern.adj_ptr;
+    const std::vector<std::int32_t> &adj_idx = pattern.adj_idx;
+    
+    std::vector<int> pos(dim);
+    for (auto i=0; i<dim; i++) {
+        pos[mcs_order[i]] = i;
+    }
+    
+    // For each v, the nbrs visited before v, except the last visited one u, must be nbrs of u
+    std::vector<int> marks(dim, -1);
+    for (auto i=0; i<dim; i++) {
+        int v = mcs_order[i];
+        
+        int u = -1;
+        for (auto s=adj_ptr[v]; s<adj_ptr[v+1]; s++) {
+            int w = adj_idx[s];
+            if (pos[w] < i && (u < 0 || pos[w] > pos[u])) {
+                u = w;
+            }
+        }
+        if (u < 0) {
+            continue;
+        }
+        
+        for (auto s=adj_ptr[u]; s<adj_ptr[u+1]; s++) {
+            marks[adj_idx[s]] = v;
+        }
+        for (auto s=adj_ptr[v]; s<adj_ptr[v+1]; s++) {
+            int w = adj_idx[s];
+            if (pos[w] < pos[u] && marks[w] != v) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+CliqueTree get_clique_tree(const CompiledPattern &pattern, const std::vector<int> &mcs_order) {
+    int dim = pattern.dim;
+    const std::vector<std::int32_t> &adj_ptr = pattern.adj_ptr;
+    const std::vector<std::int32_t> &adj_idx = pattern.adj_idx;
+    
+    std::vector<int> pos(dim);
+    for (auto i=0; i<dim; i++) {
+        pos[mcs_order[i]] = i;
+    }
+    
+    // A new clique starts whenever the no of visited nbrs does not increase
+    CliqueTree clique_tree;
+    std::vector<int> clique_of(dim, -1);
+    std::vector<std::vector<arma::uword>> cliques;
+    int card_prev = 0;
+    for (auto i=0; i<dim; i++) {
+        int v = mcs_order[i];
+        
+        std::vector<arma::uword> nbrs_visited;
+        int u = -1;
+        for (auto s=adj_ptr[v]; s<adj_ptr[v+1]; s++) {
+            int w = adj_idx[s];
+            if (pos[w] < i) {
+                nbrs_visited.push_back(w);
+                if (u < 0 || pos[w] > pos[u]) {
+                    u = w;
+                }
+            }
+        }
+        int card = nbrs_visited.size();
+        
+        if (card <= card_prev) {
+            // The parent is the clique of the last visited nbr, which contains all visited nbrs
+            cliques.push_back(nbrs_visited);
+            clique_tree.separators.push_back(arma::uvec(nbrs_visited));
+            clique_tree.parents.push_back(u < 0 ? -1 : clique_of[u]);
+        }
+        cliques.back().push_back(v);
+        clique_of[v] = cliques.size() - 1;
+        card_prev = card;
+    }
+    
+    for (auto &clique: cliques) {
+        std::sort(clique.begin(), clique.end());
+        clique_tree.cliques.push_back(arma::uvec(clique));
+    }
+    for (auto &separator: clique_tree.separators) {
+        separator = arma::sort(separator);
+    }
+    
+    return clique_tree;
+}
+
+void _bron_kerbosch(const CompiledPattern &pattern, std::vector<int> &clique, std::vector<int> candidates, std::vector<int> excluded, std::vector<arma::uvec> &cliques) {
+    
+    if (candidates.empty()) {
+        if (excluded.empty()) {
+            std::vector<arma::uword> sorted(clique.begin(), clique.end());
+            std::sort(sorted.begin(), sorted.end());
+            cliques.push_back(arma::uvec(sorted));
+        }
+        return;
+    }
+    
+    // Pivot with the most nbrs among the candidates
+    int pivot = -1, no_nbrs_max = -1;
+    for (const std::vector<int> *set: {&candidates, &excluded}) {
+        for (auto u: *set) {
+            int no_nbrs = 0;
+            for (auto v: candidates) {
+                no_nbrs += pattern.check_free(u, v) && u != v;
+            }
+            if (no_nbrs > no_nbrs_max) {
+                pivot = u;
+                no_nbrs_max = no_nbrs;
+            }
+        }
+    }
+    
+    std::vector<int> branches;
+    for (auto v: candidates) {
+        if (v == pivot || !pattern.check_free(pivot, v)) {
+            branches.push_back(v);
+        }
+    }
+    
+    for (auto v: branches) {
+        std::vector<int> candidates_next, excluded_next;
+        for (auto u: candidates) {
+            if (u != v && pattern.check_free(u, v)) {
+                candidates_next.push_back(u);
+            }
+        }
+        for (auto u: excluded) {
+            if (u != v && pattern.check_free(u, v)) {
+                excluded_next.push_back(u);
+            }
+        }
+        
+        clique.push_back(v);
+        _bron_kerbosch(pattern, clique, candidates_next, excluded_next, cliques);
+        clique.pop_back();
+        
+        candidates.erase(std::find(candidates.begin(), candidates.end(), v));
+        excluded.push_back(v);
+    }
+}
+
+std::vector<arma::uvec> get_maximal_cliques(const CompiledPattern &pattern) {
+    std::vector<arma::uvec> cliques;
+    std::vector<int> clique, candidates(pattern.dim), excluded;
+    for (auto v=0; v<pattern.dim; v++) {
+        candidates[v] = v;
+    }
+    _bron_kerbosch(pattern, clique, candidates, excluded, cliques);
+    return cliques;
+}
+
+std::vector<int> get_min_degree_order(const CompiledPattern &pattern) {
+    int dim = pattern.dim;
+    
+    // Elimination graph as sorted adjacency lists
+    std::vector<std::vector<int>> adj(dim);
+    for (auto v=0; v<dim; v++) {
+        adj[v].assign(pattern.adj_idx.begin() + pattern.adj_ptr[v], pattern.adj_idx.begin() + pattern.adj_ptr[v+1]);
+    }
+    
+    // Min-heap of (degree, vertex), so ties go to the lowest index; entries whose degree is out of date are skipped
+    typedef std::pair<int,int> DegreeEntry;
+    std::priority_queue<DegreeEntry, std::vector<DegreeEntry>, std::greater<DegreeEntry>> heap;
+    for (auto v=0; v<dim; v++) {
+        heap.push(std::make_pair((int)adj[v].size(), v));
+    }
+    
+    std::vector<bool> eliminated(dim, false);
+    std::vector<int> order;
+    order.reserve(dim);
+    std::vector<int> merged;
+    while ((int)order.size() < dim) {
+        
+        DegreeEntry entry = heap.top();
+        heap.pop();
+        int v = entry.second;
+        if (eliminated[v] || entry.first != (int)adj[v].size()) {
+            continue;
+        }
+        eliminated[v] = true;
+        order.push_back(v);
+        
+        // Nbrs of v become a clique; v leaves the graph
+        const std::vector<int> &nbrs = adj[v];
+        for (auto u: nbrs) {
+            merged.clear();
+            std::set_union(adj[u].begin(), adj[u].end(), nbrs.begin(), nbrs.end(), std::back_inserter(merged));
+            adj[u].clear();
+            for (auto w: merged) {
+                if (w != u && w != v) {
+                    adj[u].push_back(w);
+                }
+            }
+            heap.push(std::make_pair((int)adj[u].size(), u));
+        }
+        adj[v].clear();
+        adj[v].shrink_to_fit();
+    }
+    
+    return order;
+}
+
+MinimalTriangulation get_mcs_m(const CompiledPattern &pattern) {
+    int dim = pattern.dim;
+    const std::vector<std::int32_t> &adj_ptr = pattern.adj_ptr;
+    const std::vector<std::int32_t> &adj_idx = pattern.adj_idx;
+    
+    MinimalTriangulation triangulation;
+    triangulation.labels.assign(dim, 0);
+    triangulation.adj.resize(dim);
+    for (auto v=0; v<dim; v++) {
+        triangulation.adj[v].assign(adj_idx.begin() + adj_ptr[v], adj_idx.begin() + adj_ptr[v+1]);
+    }
+    
+    std::vector<int> weights(dim, 0);
+    std::vector<bool> visited(dim, false);
+    
+    // Bottleneck search: reach(u) is the min over paths from v of the max weight of the intermediate vertices; -1 for nbrs
+    std::vector<int> reach(dim);
+    std::vector<std::vector<int>> buckets(dim + 1);
+    std::vector<int> reached;
+    
+    for (auto i=0; i<dim; i++) {
+        
+        // Unvisited vertex of max weight
+        int v = -1;
+        for (auto u=0; u<dim; u++) {
+            if (!visited[u] && (v < 0 || weights[u] > weights[v])) {
+                v = u;
+            }
+        }
+        visited[v] = true;
+        triangulation.order.push_back(v);
+        triangulation.labels[v] = weights[v];
+        
+        // Buckets are indexed by reach + 1
+        std::fill(reach.begin(), reach.end(), dim);
+        reached.clear();
+        for (auto s=adj_ptr[v]; s<adj_ptr[v+1]; s++) {
+            int u = adj_idx[s];
+            if (!visited[u]) {
+                reach[u] = -1;
+                buckets[0].push_back(u);
+            }
+        }
+        for (auto b=0; b<=dim; b++) {
+            while (!buckets[b].empty()) {
+                int u = buckets[b].back();
+                buckets[b].pop_back();
+                if (reach[u] + 1 != b) {
+                    continue;
+                }
+                reached.push_back(u);
+                
+                int reach_next = std::max(reach[u], weights[u]);
+                for (auto s=adj_ptr[u]; s<adj_ptr[u+1]; s++) {
+                    int x = adj_idx[s];
+                    if (!visited[x] && reach_next < reach[x]) {
+                        reach[x] = reach_next;
+                        buckets[reach_next + 1].push_back(x);
+                    }
+                }
+            }
+        }
+        
+        // Increment after the search, since the search uses the old weights; reached non-nbrs are fill edges
+        for (auto u: reached) {
+            if (reach[u] < weights[u]) {
+                if (reach[u] >= 0) {
+                    triangulation.adj[v].push_back(u);
+                    triangulation.adj[u].push_back(v);
+                }
+                weights[u]++;
+            }
+        }
+    }
+    
+    for (auto &adj: triangulation.adj) {
+        std::sort(adj.begin(), adj.end());
+    }
+    
+    return triangulation;
+}
+
+AtomDecomposition get_atoms(const CompiledPattern &pattern) {
+    int dim = pattern.dim;
+    const std::vector<std::int32_t> &adj_ptr = pattern.adj_ptr;
+    const std::vector<std::int32_t> &adj_idx = pattern.adj_idx;
+    
+    MinimalTriangulation triangulation = get_mcs_m(pattern);
+    
+    std::vector<int> pos(dim);
+    for (auto i=0; i<dim; i++) {
+        pos[triangulation.order[i]] = i;
+    }
+    
+    AtomDecomposition decomposition;
+    std::vector<bool> alive(dim, true), in_separator(dim, false), in_component(dim, false);
+    std::vector<int> stack;
+    
+    // Generators of minimal separators, in elimination order, ie reverse visit order
+    for (auto i=dim-1; i>=1; i--) {
+        int x = triangulation.order[i];
+        if (triangulation.labels[x] > triangulation.labels[triangulation.order[i-1]] || !alive[x]) {
+            continue;
+        }
+        
+        // Separator: nbrs of x in H visited before x
+        std::vector<arma::uword> separator;
+        for (auto u: triangulation.adj[x]) {
+            if (pos[u] < i) {
+                separator.push_back(u);
+            }
+        }
+        
+        bool is_clique = true;
+        for (size_t a=0; a<separator.size() && is_clique; a++) {
+            for (size_t b=a+1; b<separator.size() && is_clique; b++) {
+                is_clique = pattern.check_free(separator[a], separator[b]);
+            }
+        }
+        if (!is_clique) {
+            continue;
+        }
+        
+        // Component of the remaining graph minus the separator containing x
+        for (auto u: separator) {
+            in_separator[u] = true;
+        }
+        std::vector<arma::uword> atom(separator);
+        in_component[x] = true;
+        stack.push_back(x);
+        while (!stack.empty()) {
+            int v = stack.back();
+            stack.pop_back();
+            atom.push_back(v);
+            for (auto s=adj_ptr[v]; s<adj_ptr[v+1]; s++) {
+                int u = adj_idx[s];
+                if (alive[u] && !in_separator[u] && !in_component[u]) {
+                    in_component[u] = true;
+                    stack.push_back(u);
+                }
+            }
+        }
+        for (auto u: separator) {
+            in_separator[u] = false;
+        }
+        for (size_t k=separator.size(); k<atom.size(); k++) {
+            alive[atom[k]] = false;
+        }
+        
+        std::sort(atom.begin(), atom.end());
+        decomposition.atoms.push_back(arma::uvec(atom));
+        decomposition.separators.push_back(arma::uvec(separator));
+    }
+    
+    // Last atom: what remains
+    std::vector<arma::uword> atom;
+    for (auto v=0; v<dim; v++) {
+        if (alive[v]) {
+            atom.push_back(v);
+        }
+    }
+    if (atom.size() > 0) {
+        decomposition.atoms.push_back(arma::uvec(atom));
+    }
+    
+    for (auto &separator: decomposition.separators) {
+        separator = arma::sort(separator);
+    }
+    
+    return decomposition;
+}
+
+};
@@ -0,0 +1,133 @@
+//
+/*
+File: ips_solver.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/ips_solver.hpp"
+#include "../include/ggm_inversion_bits/chol_factor.hpp"
+#include "../include/ggm_inversion_bits/helpers.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace ginv {
+
+std::shared_ptr<SolverBase> IPSSolver::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<IPSSolver> solver = std::make_shared<IPSSolver>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat, arma::mat> IPSSolver::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    for (auto i=0; i<_dim; i++) {
+        if (!_pattern->check_free(i, i)) {
+            throw std::invalid_argument("IPSSolver requires all diagonal elements to be free");
+        }
+    }
+    
+    std::vector<arma::uvec> cliques = get_maximal_cliques(*_pattern);
+    
+    // Inverse of the target on each clique
+    std::vector<arma::mat> prec_mats_true_cliques;
+    CholFactor chol_factor;
+    for (auto const &clique: cliques) {
+        if (!chol_factor.factorize(cov_mat_true.submat(clique, clique))) {
+            throw std::invalid_argument("Target cov mat is not positive definite on a clique!");
+        }
+        prec_mats_true_cliques.push_back(chol_factor.get_inv());
+    }
+    
+    // Start from a PD prec mat with the pattern
+    arma::mat prec_mat_curr;
+    if (prec_mat_init.n_elem > 0) {
+        prec_mat_curr = zero_non_free_elements(prec_mat_init);
+    }
+    if (prec_mat_curr.n_elem == 0 || !chol_factor.factorize(prec_mat_curr)) {
+        prec_mat_curr = arma::diagmat(1.0 / cov_mat_true.diag());
+        chol_factor.factorize(prec_mat_curr);
+    }
+    arma::mat cov_mat_curr = chol_factor.get_inv();
+    
+    arma::mat cov_mat_clique, cov_mat_res, cov_mat_rows;
+    for (auto sweep=0; sweep<max_no_sweeps; sweep++) {
+        
+        double max_abs_err = 0.0;
+        bool is_pd = true;
+        for (size_t c=0; c<cliques.size() && is_pd; c++) {
+            const arma::uvec &clique = cliques[c];
+            
+            cov_mat_clique = cov_mat_curr.submat(clique, clique);
+            cov_mat_res = cov_mat_true.submat(clique, clique) - cov_mat_clique;
+            max_abs_err = std::max(max_abs_err, arma::abs(cov_mat_res).max());
+            
+            is_pd = chol_factor.factorize(cov_mat_clique);
+            if (!is_pd) {
+                break;
+            }
+            const arma::mat &prec_mat_clique = chol_factor.get_inv();
+            
+            // Sigma_CC^-1 Sigma_{C:}
+            cov_mat_rows = prec_mat_clique * cov_mat_curr.rows(clique);
+            
+            cov_mat_curr += cov_mat_rows.t() * cov_mat_res * cov_mat_rows;
+            prec_mat_curr.submat(clique, clique) += prec_mats_true_cliques[c] - prec_mat_clique;
+        }
+        
+        if (!is_pd) {
+            if (options.log_progress) {
+                spdlog::warn(_get_log_header(options, sweep, max_no_sweeps) + "Stopping: cov mat on a clique is not positive definite");
+            }
+            break;
+        }
+        
+        // Round-off would slowly break the symmetry
+        cov_mat_curr = 0.5 * (cov_mat_curr + cov_mat_curr.t());
+        
+        // Log
+        if (options.log_progress && sweep % options.log_interval == 0) {
+            spdlog::info(_get_log_header(options, sweep, max_no_sweeps) + "max abs err of cov mat on the cliques: {:e}", max_abs_err);
+        }
+        
+        // Write
+        if (options.write_progress && sweep % options.write_interval == 0) {
+            assert (options.write_dir != "");
+            write_mat(options.write_dir + "prec_mat.txt", sweep, sweep!=0, prec_mat_curr);
+            write_mat(options.write_dir + "cov_mat.txt", sweep, sweep!=0, cov_mat_curr);
+        }
+        
+        if (max_abs_err < conv_max_abs_err) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, sweep, max_no_sweeps) + "Converged: max abs err of cov mat on the cliques: {:e} is less than limit: {:e}", max_abs_err, conv_max_abs_err);
+            }
+            break;
+        }
+    }
+    
+    return std::make_pair(cov_mat_curr, prec_mat_curr);
+}
+
+}
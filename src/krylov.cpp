@@ -0,0 +1,203 @@
+//
+/*
+File: krylov.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/krylov.hpp"
+
+namespace ginv {
+
+arma::vec solve_cg_truncated(const MatVecProd &mat_vec_prod, const arma::vec &b, double tol, int max_no_steps) {
+    
+    arma::vec x = arma::zeros(b.n_elem);
+    arma::vec res = b;
+    arma::vec dir = b;
+    double res_norm_sq = arma::dot(res, res);
+    
+    for (auto i=0; i<max_no_steps; i++) {
+        if (sqrt(res_norm_sq) < tol) {
+            break;
+        }
+        
+        arma::vec prod = mat_vec_prod(dir);
+        double curvature = arma::dot(dir, prod);
+        
+        // Negative curvature: stop
+        if (curvature <= 0) {
+            if (i == 0) {
+                return b;
+            }
+            break;
+        }
+        
+        double alpha = res_norm_sq / curvature;
+        x += alpha * dir;
+        res -= alpha * prod;
+        
+        double res_norm_sq_new = arma::dot(res, res);
+        dir = res + (res_norm_sq_new / res_norm_sq) * dir;
+        res_norm_sq = res_norm_sq_new;
+    }
+    
+    return x;
+}
+
+/// Step length tau >= 0 such that |x + tau dir| = radius, for |x| <= radius
+static double _get_step_to_boundary(const arma::vec &x, const arma::vec &dir, double radius) {
+    double a = arma::dot(dir, dir);
+    double b = arma::dot(x, dir);
+    double c = arma::dot(x, x) - radius * radius;
+    return (- b + sqrt(std::max(b * b - a * c, 0.0))) / a;
+}
+
+arma::vec solve_cg_steihaug(const MatVecProd &mat_vec_prod, const arma::vec &b, double radius, double tol, int max_no_steps, bool &on_boundary) {
+    
+    on_boundary = false;
+    arma::vec x = arma::zeros(b.n_elem);
+    arma::vec res = b;
+    arma::vec dir = b;
+    double res_norm_sq = arma::dot(res, res);
+    
+    for (auto i=0; i<max_no_steps; i++) {
+        if (sqrt(res_norm_sq) < tol) {
+            break;
+        }
+        
+        arma::vec prod = mat_vec_prod(dir);
+        double curvature = arma::dot(dir, prod);
+        
+        // Negative curvature: the model decreases without bound along dir, so go to the boundary
+        if (curvature <= 0) {
+            x += _get_step_to_boundary(x, dir, radius) * dir;
+            on_boundary = true;
+            break;
+        }
+        
+        // Step would leave the trust region: stop at the boundary
+        double alpha = res_norm_sq / curvature;
+        if (arma::norm(x + alpha * dir) >= radius) {
+            x += _get_step_to_boundary(x, dir, radius) * dir;
+            on_boundary = true;
+            break;
+        }
+        
+        x += alpha * dir;
+        res -= alpha * prod;
+        
+        double res_norm_sq_new = arma::dot(res, res);
+        dir = res + (res_norm_sq_new / res_norm_sq) * dir;
+        res_norm_sq = res_norm_sq_new;
+    }
+    
+    return x;
+}
+
+arma::vec solve_gmres(const MatVecProd &mat_vec_prod, const arma::vec &b, double tol, int restart, int max_no_steps) {
+    
+    arma::vec x = arma::zeros(b.n_elem);
+    
+    arma::mat basis(b.n_elem, restart+1);
+    arma::mat hess(restart+1, restart);
+    arma::vec rot_cos(restart), rot_sin(restart), res_proj(restart+1);
+    
+    int no_steps = 0;
+    while (no_steps < max_no_steps) {
+        
+        // Residual of the current iterate
+        arma::vec res = b;
+        if (no_steps > 0) {
+            res -= mat_vec_prod(x);
+        }
+        double res_norm = arma::norm(res);
+        if (res_norm < tol) {
+            break;
+        }
+        
+        basis.col(0) = res / res_norm;
+        hess.zeros();
+        res_proj.zeros();
+        res_proj(0) = res_norm;
+        
+        // Arnoldi
+        int no_basis = 0;
+        for (auto j=0; j<restart && no_steps<max_no_steps; j++) {
+            no_steps++;
+            
+            arma::vec w = mat_vec_prod(basis.col(j));
+            for (auto i=0; i<=j; i++) {
+                hess(i,j) = arma::dot(w, basis.col(i));
+                w -= hess(i,j) * basis.col(i);
+            }
+            hess(j+1,j) = arma::norm(w);
+            
+            // Apply previous rotations to the new column
+            for (auto i=0; i<j; i++) {
+                double tmp = rot_cos(i) * hess(i,j) + rot_sin(i) * hess(i+1,j);
+                hess(i+1,j) = - rot_sin(i) * hess(i,j) + rot_cos(i) * hess(i+1,j);
+                hess(i,j) = tmp;
+            }
+            
+            // New rotation to eliminate the subdiagonal
+            double denom = sqrt(pow(hess(j,j),2) + pow(hess(j+1,j),2));
+            if (denom == 0.0) {
+                break;
+            }
+            bool breakdown = (hess(j+1,j) == 0.0);
+            if (!breakdown) {
+                basis.col(j+1) = w / hess(j+1,j);
+            }
+            
+            rot_cos(j) = hess(j,j) / denom;
+            rot_sin(j) = hess(j+1,j) / denom;
+            hess(j,j) = denom;
+            hess(j+1,j) = 0.0;
+            res_proj(j+1) = - rot_sin(j) * res_proj(j);
+            res_proj(j) = rot_cos(j) * res_proj(j);
+            
+            no_basis = j+1;
+            if (breakdown || std::abs(res_proj(j+1)) < tol) {
+                break;
+            }
+        }
+        
+        if (no_basis == 0) {
+            break;
+        }
+        
+        // Least squares solution in the Krylov subspace
+        arma::vec y = arma::solve(arma::trimatu(hess.submat(0, 0, no_basis-1, no_basis-1)), res_proj.subvec(0, no_basis-1));
+        x += basis.cols(0, no_basis-1) * y;
+        
+        if (std::abs(res_proj(no_basis)) < tol) {
+            break;
+        }
+    }
+    
+    return x;
+}
+
+};
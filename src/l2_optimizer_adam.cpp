@@ -29,17 +29,32 @@ SOFTWARE.
 
 #include "../include/ggm_inversion_bits/l2_optimizer_adam.hpp"
 
+#include <spdlog/spdlog.h>
+
 namespace ginv {
         
-std::pair<arma::mat,arma::mat> L2OptimizerAdam::solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+std::shared_ptr<SolverBase> L2OptimizerAdam::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<L2OptimizerAdam> solver = std::make_shared<L2OptimizerAdam>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat,arma::mat> L2OptimizerAdam::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
     
     arma::mat prec_mat_curr = prec_mat_init;
-
-    arma::mat adam_mt, adam_vt;
+    
+    // All buffers are allocated here; the loop below only writes into them
+    Workspace workspace(_dim);
+    CholFactor &chol_factor = workspace.chol_factor;
+    _factorize_init(chol_factor, prec_mat_curr);
+    
+    arma::mat adam_mt = arma::zeros(_dim, _dim);
+    arma::mat adam_vt = arma::zeros(_dim, _dim);
+    const arma::mat &derivs = workspace.derivs;
 
     for (size_t i=0; i<no_opt_steps; i++) {
                 
-        arma::mat cov_mat_curr = arma::inv(prec_mat_curr);
+        const arma::mat &cov_mat_curr = chol_factor.get_inv();
         
         // Log
         _log_progress_if_needed(options, i, no_opt_steps, cov_mat_curr, cov_mat_true, prec_mat_curr);
@@ -47,27 +62,38 @@ std::pair<arma::mat,arma::mat> L2OptimizerAdam::solve(const arma::mat &cov_mat_t
         // Write
         _write_progress_if_needed(options, i, prec_mat_curr, cov_mat_curr, cov_mat_true);
         
-        arma::mat derivs = get_deriv_mat(cov_mat_curr, cov_mat_true);
+        get_deriv_mat(cov_mat_curr, cov_mat_true, workspace.derivs, workspace);
 
+        // Moments are updated in place
         if (i == 0) {
             adam_mt = derivs;
+            adam_vt = arma::square(derivs);
         } else {
-            adam_mt = adam_beta_1 * adam_mt + (1 - adam_beta_1) * derivs;
+            adam_mt *= adam_beta_1;
+            adam_mt += (1 - adam_beta_1) * derivs;
+            adam_vt *= adam_beta_2;
+            adam_vt += (1 - adam_beta_2) * arma::square(derivs);
         }
+        
+        // Bias corrections folded into scalars
+        double adam_mt_corr = 1.0 / (1 - pow(adam_beta_1, i+1));
+        double adam_vt_corr = 1.0 / (1 - pow(adam_beta_2, i+1));
 
-        if (i == 0) {
-            adam_vt = pow(derivs,2);
-        } else {
-            adam_vt = adam_beta_2 * adam_vt + (1 - adam_beta_2) * pow(derivs,2);
+        workspace.prec_mat_prev = prec_mat_curr;
+        prec_mat_curr -= (lr * adam_mt_corr) * adam_mt / (arma::sqrt(adam_vt_corr * adam_vt) + adam_eps);
+        
+        // Stop at the last PD iterate
+        if (!chol_factor.factorize(prec_mat_curr)) {
+            if (options.log_progress) {
+                spdlog::warn(_get_log_header(options, i, no_opt_steps) + "Stopping: prec mat left the positive definite cone");
+            }
+            prec_mat_curr = workspace.prec_mat_prev;
+            chol_factor.factorize(prec_mat_curr);
+            break;
         }
-                                
-        arma::mat adam_mt_corr = adam_mt / (1 - pow(adam_beta_1, i+1));
-        arma::mat adam_vt_corr = adam_vt / (1 - pow(adam_beta_2, i+1));
-
-        prec_mat_curr -= lr * adam_mt_corr / (sqrt(adam_vt_corr) + adam_eps);
     }
 
-    return std::make_pair(arma::inv(prec_mat_curr), prec_mat_curr);
+    return std::make_pair(chol_factor.get_inv(), prec_mat_curr);
 }
 
 }
@@ -32,6 +32,9 @@ SOFTWARE.
 
 #include <spdlog/spdlog.h>
 
+#include <cmath>
+#include <limits>
+
 namespace ginv {
 
 std::pair<double,double> L2OptimizerBase::get_err(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_targets) const {
@@ -45,7 +48,17 @@ std::pair<double,double> L2OptimizerBase::get_err(const arma::mat &cov_mat_curr,
     return std::make_pair(ave_err, max_err);
 }
 
-void L2OptimizerBase::_log_progress_if_needed(Options options, int opt_step, int no_opt_steps, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_targets, const arma::mat &prec_mat_curr) const {
+L2OptimizerBase::Workspace::Workspace(int dim) {
+    res_mat.zeros(dim, dim);
+    prod_mat.zeros(dim, dim);
+    tmp_mat.zeros(dim, dim);
+    derivs.zeros(dim, dim);
+    derivs_trial.zeros(dim, dim);
+    update_mat.zeros(dim, dim);
+    prec_mat_prev.zeros(dim, dim);
+}
+
+void L2OptimizerBase::_log_progress_if_needed(const Options &options, int opt_step, int no_opt_steps, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_targets, const arma::mat &prec_mat_curr) const {
     if (options.log_progress) {
         if (opt_step % options.log_interval == 0) {
             
@@ -60,8 +73,6 @@ void L2OptimizerBase::_log_progress_if_needed(Options options, int opt_step, int
             if (options.log_mats) {
                 spdlog::info(header + "Cov mat curr:");
                 _log_mat_info(cov_mat_curr, header);
-                spdlog::info(header + "Inv of current prec mat:");
-                _log_mat_info(arma::inv(prec_mat_curr), header);
                 spdlog::info(header + "Prec mat curr:");
                 _log_mat_info(prec_mat_curr, header);
             }
@@ -69,21 +80,21 @@ void L2OptimizerBase::_log_progress_if_needed(Options options, int opt_step, int
     }
 }
 
-void L2OptimizerBase::_write_progress_if_needed(Options options, int opt_step, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const {
+void L2OptimizerBase::_write_progress_if_needed(const Options &options, int opt_step, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const {
     if (options.write_progress) {
         assert (options.write_dir != "");
         
         if (opt_step % options.write_interval == 0) {
             // Write
             std::string fname = options.write_dir + "prec_mat.txt";
-            write_submat(fname, opt_step, opt_step!=0, prec_mat_curr, _idx_pairs_free);
+            write_submat(fname, opt_step, opt_step!=0, prec_mat_curr, _pattern->idx_pairs_free);
             
             fname = options.write_dir + "cov_mat.txt";
-            write_submat(fname, opt_step, opt_step!=0, cov_mat_curr, _idx_pairs_free);
+            write_submat(fname, opt_step, opt_step!=0, cov_mat_curr, _pattern->idx_pairs_free);
             
             if (opt_step == 0) {
                 fname = options.write_dir + "cov_mat_targets.txt";
-                write_submat(fname, false, cov_mat_true, _idx_pairs_free);
+                write_submat(fname, false, cov_mat_true, _pattern->idx_pairs_free);
             }
             
             auto pr = get_err(cov_mat_curr, cov_mat_true);
@@ -95,6 +106,12 @@ void L2OptimizerBase::_write_progress_if_needed(Options options, int opt_step, c
     }
 }
 
+void L2OptimizerBase::_factorize_init(CholFactor &chol_factor, const arma::mat &prec_mat_init) const {
+    if (!chol_factor.factorize(prec_mat_init)) {
+        throw std::invalid_argument("Initial prec mat is not positive definite!");
+    }
+}
+
 double L2OptimizerBase::_get_first_deriv_inverse_mat(const arma::mat &cov_mat_curr, int d1, int d2, int n1, int n2) const {
     double ret = 0.0;
     ret -= cov_mat_curr(n1,d1) * cov_mat_curr(n2,d2);
@@ -127,25 +144,75 @@ double L2OptimizerBase::_get_second_deriv_inverse_mat(const arma::mat &cov_mat_c
 double L2OptimizerBase::get_obj_func_val(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const {
 
     double val = 0.0;
-    for (auto idx_pair: _idx_pairs_free) {
-        int i = idx_pair.first;
-        int j = idx_pair.second;
-        
-        val += pow(cov_mat_curr(i,j) - cov_mat_true(i,j), 2);
+    const double *cov_curr_mem = cov_mat_curr.memptr();
+    const double *cov_true_mem = cov_mat_true.memptr();
+    const arma::uword *offsets = _pattern->free_offsets.data();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        double res = cov_curr_mem[offsets[s]] - cov_true_mem[offsets[s]];
+        val += res * res;
     }
     
     return val;
 }
 
+void L2OptimizerBase::_get_res_mat(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true, arma::mat &res_mat) const {
+    
+    // One-sided, since each free pair enters the obj func once
+    res_mat.zeros(_dim, _dim);
+    double *res_mem = res_mat.memptr();
+    const double *cov_curr_mem = cov_mat_curr.memptr();
+    const double *cov_true_mem = cov_mat_true.memptr();
+    const arma::uword *offsets = _pattern->free_offsets.data();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        res_mem[offsets[s]] += 2 * (cov_curr_mem[offsets[s]] - cov_true_mem[offsets[s]]);
+    }
+}
+
+void L2OptimizerBase::_gather_deriv_mat(const arma::mat &prod_mat, arma::mat &derivs) const {
+    
+    derivs.zeros(_dim, _dim);
+    double *derivs_mem = derivs.memptr();
+    const double *prod_mem = prod_mat.memptr();
+    const arma::uword *offsets = _pattern->free_offsets.data();
+    const arma::uword *offsets_trans = _pattern->free_offsets_trans.data();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        double deriv = - prod_mem[offsets[s]];
+        if (offsets[s] != offsets_trans[s]) {
+            deriv -= prod_mem[offsets_trans[s]];
+        }
+        
+        derivs_mem[offsets[s]] = deriv;
+        derivs_mem[offsets_trans[s]] = deriv;
+    }
+}
+
 arma::mat L2OptimizerBase::get_deriv_mat(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const {
+    Workspace workspace(_dim);
+    arma::mat derivs;
+    get_deriv_mat(cov_mat_curr, cov_mat_true, derivs, workspace);
+    return derivs;
+}
+
+void L2OptimizerBase::get_deriv_mat(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true, arma::mat &derivs, Workspace &workspace) const {
+    
+    // Sum over (k,l) of the first derivs of the inverse is - Sigma * R * Sigma
+    _get_res_mat(cov_mat_curr, cov_mat_true, workspace.res_mat);
+    workspace.tmp_mat = cov_mat_curr * workspace.res_mat;
+    workspace.prod_mat = workspace.tmp_mat * cov_mat_curr;
+    
+    // Gather at the free elements
+    _gather_deriv_mat(workspace.prod_mat, derivs);
+}
+
+arma::mat L2OptimizerBase::get_deriv_mat_reference(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const {
     
     arma::mat derivs = arma::zeros(_dim, _dim);
-    for (auto idx_pair_deriv: _idx_pairs_free) {
+    for (auto idx_pair_deriv: _pattern->idx_pairs_free) {
         int i = idx_pair_deriv.first;
         int j = idx_pair_deriv.second;
         
         double deriv = 0.0;
-        for (auto idx_pair_sum: _idx_pairs_free) {
+        for (auto idx_pair_sum: _pattern->idx_pairs_free) {
             int k = idx_pair_sum.first;
             int l = idx_pair_sum.second;
             
@@ -166,19 +233,19 @@ arma::vec L2OptimizerBase::get_deriv_vec(const arma::mat &cov_mat_curr, const ar
 
 arma::mat L2OptimizerBase::get_hessian(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const {
     
-    arma::mat hessian = arma::zeros(_idx_pairs_free.size(), _idx_pairs_free.size());
-    for (size_t idx_1=0; idx_1<_idx_pairs_free.size(); idx_1++) {
-        auto idx_pair_deriv_1 = _idx_pairs_free.at(idx_1);
+    arma::mat hessian = arma::zeros(_pattern->idx_pairs_free.size(), _pattern->idx_pairs_free.size());
+    for (size_t idx_1=0; idx_1<_pattern->idx_pairs_free.size(); idx_1++) {
+        auto idx_pair_deriv_1 = _pattern->idx_pairs_free.at(idx_1);
         int i = idx_pair_deriv_1.first;
         int j = idx_pair_deriv_1.second;
         
-        for (size_t idx_2=0; idx_2<_idx_pairs_free.size(); idx_2++) {
-            auto idx_pair_deriv_2 = _idx_pairs_free.at(idx_2);
+        for (size_t idx_2=0; idx_2<_pattern->idx_pairs_free.size(); idx_2++) {
+            auto idx_pair_deriv_2 = _pattern->idx_pairs_free.at(idx_2);
             int x = idx_pair_deriv_2.first;
             int y = idx_pair_deriv_2.second;
             
             double deriv = 0.0;
-            for (auto idx_pair_sum: _idx_pairs_free) {
+            for (auto idx_pair_sum: _pattern->idx_pairs_free) {
                 int k = idx_pair_sum.first;
                 int l = idx_pair_sum.second;
                                 
@@ -193,6 +260,119 @@ arma::mat L2OptimizerBase::get_hessian(const arma::mat &cov_mat_curr, const arma
     return hessian;
 }
 
-};
+arma::vec L2OptimizerBase::get_hessian_vec_prod(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true, const arma::vec &vec) const {
+    
+    // Direction in the prec mat and the resulting change in the cov mat
+    arma::mat dir_mat = free_vec_to_mat(vec);
+    arma::mat cov_mat_dir = - cov_mat_curr * dir_mat * cov_mat_curr;
+    
+    // Residuals and their change along the direction
+    arma::mat res_mat;
+    _get_res_mat(cov_mat_curr, cov_mat_true, res_mat);
+    arma::mat res_mat_dir = arma::zeros(_dim, _dim);
+    double *res_dir_mem = res_mat_dir.memptr();
+    const double *cov_dir_mem = cov_mat_dir.memptr();
+    const arma::uword *offsets = _pattern->free_offsets.data();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        res_dir_mem[offsets[s]] += 2 * cov_dir_mem[offsets[s]];
+    }
+    
+    // Change in Sigma * R * Sigma along the direction
+    arma::mat prod_mat_dir = cov_mat_dir * res_mat * cov_mat_curr;
+    prod_mat_dir += cov_mat_curr * res_mat_dir * cov_mat_curr;
+    prod_mat_dir += cov_mat_curr * res_mat * cov_mat_dir;
+    
+    arma::mat derivs_dir;
+    _gather_deriv_mat(prod_mat_dir, derivs_dir);
+    return free_mat_to_vec(derivs_dir);
+}
 
+arma::mat L2OptimizerBase::get_res_jacobian(const arma::mat &cov_mat_curr) const {
+    
+    int no_free = _pattern->get_no_free();
+    arma::mat jacobian(no_free, no_free);
+    for (auto s=0; s<no_free; s++) {
+        int i = _pattern->free_rows[s];
+        int j = _pattern->free_cols[s];
+        for (auto k=0; k<no_free; k++) {
+            jacobian(k,s) = _get_first_deriv_inverse_mat(cov_mat_curr, i, j, _pattern->free_rows[k], _pattern->free_cols[k]);
+        }
+    }
+    
+    return jacobian;
+}
 
+arma::vec L2OptimizerBase::get_res_jacobian_vec_prod(const arma::mat &cov_mat_curr, const arma::vec &vec) const {
+    
+    // Change in the cov mat along the direction
+    arma::mat dir_mat = free_vec_to_mat(vec);
+    arma::mat cov_mat_dir = - cov_mat_curr * dir_mat * cov_mat_curr;
+    return free_mat_to_vec(cov_mat_dir);
+}
+
+arma::vec L2OptimizerBase::get_res_jacobian_trans_vec_prod(const arma::mat &cov_mat_curr, const arma::vec &vec) const {
+    
+    // As get_deriv_mat with the residuals replaced by vec
+    arma::mat vec_mat = arma::zeros(_dim, _dim);
+    double *vec_mat_mem = vec_mat.memptr();
+    const arma::uword *offsets = _pattern->free_offsets.data();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        vec_mat_mem[offsets[s]] = vec(s);
+    }
+    arma::mat prod_mat = cov_mat_curr * vec_mat * cov_mat_curr;
+    
+    arma::mat derivs;
+    _gather_deriv_mat(prod_mat, derivs);
+    return free_mat_to_vec(derivs);
+}
+
+double L2OptimizerBase::_get_step_size_line_search(const arma::mat &cov_mat_true, double obj_func_0, double slope, double step_size_init, double armijo_c, double wolfe_c, int max_no_backtracks, arma::mat &prec_mat_curr, Workspace &workspace) const {
+    
+    // This had better be a descent direction
+    if (slope >= 0) {
+        prec_mat_curr = workspace.prec_mat_prev;
+        workspace.chol_factor.factorize(prec_mat_curr);
+        return 0.0;
+    }
+    
+    const double *update_mem = workspace.update_mat.memptr();
+    const double *derivs_trial_mem = workspace.derivs_trial.memptr();
+    const arma::uword *offsets = _pattern->free_offsets.data();
+    
+    double step_size_lower = 0.0;
+    double step_size_upper = std::numeric_limits<double>::infinity();
+    double step_size = step_size_init;
+    for (auto k=0; k<max_no_backtracks; k++) {
+        prec_mat_curr = workspace.prec_mat_prev;
+        prec_mat_curr += step_size * workspace.update_mat;
+        
+        // Reject steps that leave the PD cone or do not decrease enough
+        if (!workspace.chol_factor.factorize(prec_mat_curr) || get_obj_func_val(workspace.chol_factor.get_inv(), cov_mat_true) > obj_func_0 + armijo_c * step_size * slope) {
+            step_size_upper = step_size;
+        } else if (wolfe_c > 0) {
+            get_deriv_mat(workspace.chol_factor.get_inv(), cov_mat_true, workspace.derivs_trial, workspace);
+            double slope_trial = 0.0;
+            for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+                slope_trial += derivs_trial_mem[offsets[s]] * update_mem[offsets[s]];
+            }
+            if (slope_trial >= wolfe_c * slope) {
+                return step_size;
+            }
+            step_size_lower = step_size;
+        } else {
+            return step_size;
+        }
+        
+        step_size = std::isinf(step_size_upper) ? 2.0 * step_size_lower : 0.5 * (step_size_lower + step_size_upper);
+    }
+    
+    // The largest step known to be acceptable, if any
+    prec_mat_curr = workspace.prec_mat_prev;
+    if (step_size_lower > 0) {
+        prec_mat_curr += step_size_lower * workspace.update_mat;
+    }
+    workspace.chol_factor.factorize(prec_mat_curr);
+    return step_size_lower;
+}
+
+};
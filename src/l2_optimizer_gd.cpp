@@ -29,14 +29,32 @@ SOFTWARE.
 
 #include "../include/ggm_inversion_bits/l2_optimizer_gd.hpp"
 
+#include <spdlog/spdlog.h>
+
 namespace ginv {
 
-std::pair<arma::mat, arma::mat> L2OptimizerGD::solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+std::shared_ptr<SolverBase> L2OptimizerGD::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<L2OptimizerGD> solver = std::make_shared<L2OptimizerGD>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat, arma::mat> L2OptimizerGD::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    if (line_search != "none" && line_search != "armijo" && line_search != "wolfe") {
+        throw std::invalid_argument("Line search must be one of: none, armijo, wolfe");
+    }
 
     arma::mat prec_mat_curr = prec_mat_init;
-        
+    
+    // All buffers are allocated here; the loop below only writes into them
+    Workspace workspace(_dim);
+    CholFactor &chol_factor = workspace.chol_factor;
+    _factorize_init(chol_factor, prec_mat_curr);
+    
+    double step_size_init = lr;
     for (size_t i=0; i<no_opt_steps; i++) {
-        arma::mat cov_mat_curr = arma::inv(prec_mat_curr);
+        const arma::mat &cov_mat_curr = chol_factor.get_inv();
                     
         // Log if needed
         _log_progress_if_needed(options, i, no_opt_steps, cov_mat_curr, cov_mat_true, prec_mat_curr);
@@ -44,11 +62,53 @@ std::pair<arma::mat, arma::mat> L2OptimizerGD::solve(const arma::mat &cov_mat_tr
         // Write if needed
         _write_progress_if_needed(options, i, prec_mat_curr, cov_mat_curr, cov_mat_true);
         
-        arma::mat derivs = get_deriv_mat(cov_mat_curr, cov_mat_true);
-        prec_mat_curr -= lr * derivs;
+        get_deriv_mat(cov_mat_curr, cov_mat_true, workspace.derivs, workspace);
+        workspace.prec_mat_prev = prec_mat_curr;
+        
+        if (line_search != "none") {
+            
+            double max_abs_deriv = arma::abs(workspace.derivs).max();
+            if (max_abs_deriv < conv_max_abs_deriv) {
+                if (options.log_progress) {
+                    spdlog::info(_get_log_header(options, i, no_opt_steps) + "Converged: max absolute deriv: {:e} is less than limit: {:e}", max_abs_deriv, conv_max_abs_deriv);
+                }
+                break;
+            }
+            
+            // Along - derivs; the line search leaves the accepted iterate factorized
+            workspace.update_mat = workspace.derivs;
+            workspace.update_mat *= -1.0;
+            double obj_func_0 = get_obj_func_val(cov_mat_curr, cov_mat_true);
+            double slope = 0.0;
+            const double *derivs_mem = workspace.derivs.memptr();
+            for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+                slope -= derivs_mem[_pattern->free_offsets[s]] * derivs_mem[_pattern->free_offsets[s]];
+            }
+            double step_size = _get_step_size_line_search(cov_mat_true, obj_func_0, slope, step_size_init, armijo_c, (line_search == "wolfe") ? wolfe_c : 0.0, max_no_backtracks, prec_mat_curr, workspace);
+            if (step_size == 0.0) {
+                if (options.log_progress) {
+                    spdlog::info(_get_log_header(options, i, no_opt_steps) + "Stopping: line search failed to find an acceptable step");
+                }
+                break;
+            }
+            step_size_init = 2.0 * step_size;
+            continue;
+        }
+        
+        prec_mat_curr -= lr * workspace.derivs;
+        
+        // Stop at the last PD iterate
+        if (!chol_factor.factorize(prec_mat_curr)) {
+            if (options.log_progress) {
+                spdlog::warn(_get_log_header(options, i, no_opt_steps) + "Stopping: prec mat left the positive definite cone");
+            }
+            prec_mat_curr = workspace.prec_mat_prev;
+            chol_factor.factorize(prec_mat_curr);
+            break;
+        }
     }
     
-    return std::make_pair(arma::inv(prec_mat_curr), prec_mat_curr);
+    return std::make_pair(chol_factor.get_inv(), prec_mat_curr);
 }
 
 }
@@ -0,0 +1,176 @@
+//
+/*
+File: l2_optimizer_lbfgs.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/l2_optimizer_lbfgs.hpp"
+
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+namespace ginv {
+
+L2OptimizerLBFGS::LBFGSWorkspace::LBFGSWorkspace(int dim, int no_free, int history_size) : Workspace(dim) {
+    this->dim = dim;
+    this->no_free = no_free;
+    this->history_size = history_size;
+    s_vecs.zeros(no_free, history_size);
+    y_vecs.zeros(no_free, history_size);
+    rhos.zeros(history_size);
+    alphas.zeros(history_size);
+    deriv_vec.zeros(no_free);
+    deriv_vec_prev.zeros(no_free);
+    prec_vec.zeros(no_free);
+    prec_vec_prev.zeros(no_free);
+    update_vec.zeros(no_free);
+}
+
+std::shared_ptr<SolverBase> L2OptimizerLBFGS::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<L2OptimizerLBFGS> solver = std::make_shared<L2OptimizerLBFGS>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+L2OptimizerLBFGS::LBFGSWorkspace& L2OptimizerLBFGS::_get_workspace() const {
+    
+    // One cache per thread, so concurrent solves in a batch do not share buffers; most recently used first
+    thread_local std::vector<std::unique_ptr<LBFGSWorkspace>> workspaces;
+    int no_free = _pattern->get_no_free();
+    for (size_t w=0; w<workspaces.size(); w++) {
+        if (workspaces[w]->dim == _dim && workspaces[w]->no_free == no_free && workspaces[w]->history_size == history_size) {
+            std::rotate(workspaces.begin(), workspaces.begin() + w, workspaces.begin() + w + 1);
+            return *workspaces.front();
+        }
+    }
+    
+    // Evict the least recently used
+    if (workspaces.size() >= max_no_cached_workspaces) {
+        workspaces.pop_back();
+    }
+    workspaces.insert(workspaces.begin(), std::make_unique<LBFGSWorkspace>(_dim, no_free, history_size));
+    return *workspaces.front();
+}
+
+std::pair<arma::mat, arma::mat> L2OptimizerLBFGS::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    if (history_size < 1) {
+        throw std::invalid_argument("History size must be at least 1");
+    }
+    
+    LBFGSWorkspace &workspace = _get_workspace();
+    CholFactor &chol_factor = workspace.chol_factor;
+    
+    arma::mat prec_mat_curr = prec_mat_init;
+    _factorize_init(chol_factor, prec_mat_curr);
+    
+    // Ring buffers: the newest pair is in col head - 1
+    int head = 0, no_pairs = 0;
+    for (auto i=0; i<no_opt_steps; i++) {
+        const arma::mat &cov_mat_curr = chol_factor.get_inv();
+        
+        // Log if needed
+        _log_progress_if_needed(options, i, no_opt_steps, cov_mat_curr, cov_mat_true, prec_mat_curr);
+        
+        // Write if needed
+        _write_progress_if_needed(options, i, prec_mat_curr, cov_mat_curr, cov_mat_true);
+        
+        get_deriv_mat(cov_mat_curr, cov_mat_true, workspace.derivs, workspace);
+        free_mat_to_vec(workspace.derivs, workspace.deriv_vec);
+        free_mat_to_vec(prec_mat_curr, workspace.prec_vec);
+        
+        // Check convergence
+        double max_abs_deriv = arma::abs(workspace.deriv_vec).max();
+        if (max_abs_deriv < conv_max_abs_deriv) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, i, no_opt_steps) + "Converged: max absolute deriv: {:e} is less than limit: {:e}", max_abs_deriv, conv_max_abs_deriv);
+            }
+            break;
+        }
+        
+        // New pair, skipped if the curvature is not positive
+        if (i > 0) {
+            workspace.s_vecs.col(head) = workspace.prec_vec - workspace.prec_vec_prev;
+            workspace.y_vecs.col(head) = workspace.deriv_vec - workspace.deriv_vec_prev;
+            double curvature = arma::dot(workspace.s_vecs.col(head), workspace.y_vecs.col(head));
+            if (curvature > 0) {
+                workspace.rhos(head) = 1.0 / curvature;
+                head = (head + 1) % history_size;
+                no_pairs = std::min(no_pairs + 1, history_size);
+            }
+        }
+        
+        // Two-loop recursion, newest pair first
+        workspace.update_vec = - workspace.deriv_vec;
+        for (auto k=0; k<no_pairs; k++) {
+            int idx = (head - 1 - k + history_size) % history_size;
+            workspace.alphas(idx) = workspace.rhos(idx) * arma::dot(workspace.s_vecs.col(idx), workspace.update_vec);
+            workspace.update_vec -= workspace.alphas(idx) * workspace.y_vecs.col(idx);
+        }
+        
+        // Initial inverse Hessian s^T y / y^T y; before any pairs, a step of unit length
+        double gamma;
+        if (no_pairs > 0) {
+            int idx = (head - 1 + history_size) % history_size;
+            gamma = 1.0 / (workspace.rhos(idx) * arma::dot(workspace.y_vecs.col(idx), workspace.y_vecs.col(idx)));
+        } else {
+            gamma = 1.0 / arma::norm(workspace.deriv_vec);
+        }
+        workspace.update_vec *= gamma;
+        
+        for (auto k=no_pairs-1; k>=0; k--) {
+            int idx = (head - 1 - k + history_size) % history_size;
+            double beta = workspace.rhos(idx) * arma::dot(workspace.y_vecs.col(idx), workspace.update_vec);
+            workspace.update_vec += (workspace.alphas(idx) - beta) * workspace.s_vecs.col(idx);
+        }
+        
+        // Restart from steepest descent if this is not a descent direction
+        double slope = arma::dot(workspace.deriv_vec, workspace.update_vec);
+        if (slope >= 0) {
+            no_pairs = 0;
+            workspace.update_vec = - workspace.deriv_vec / arma::norm(workspace.deriv_vec);
+            slope = arma::dot(workspace.deriv_vec, workspace.update_vec);
+        }
+        
+        // Line search; leaves the accepted iterate factorized
+        double obj_func_0 = get_obj_func_val(cov_mat_curr, cov_mat_true);
+        workspace.prec_vec_prev = workspace.prec_vec;
+        workspace.deriv_vec_prev = workspace.deriv_vec;
+        workspace.prec_mat_prev = prec_mat_curr;
+        free_vec_to_mat(workspace.update_vec, workspace.update_mat);
+        double step_size = _get_step_size_line_search(cov_mat_true, obj_func_0, slope, 1.0, armijo_c, wolfe_c, max_no_backtracks, prec_mat_curr, workspace);
+        if (step_size == 0.0) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, i, no_opt_steps) + "Stopping: line search failed to find an acceptable step");
+            }
+            break;
+        }
+    }
+    
+    return std::make_pair(chol_factor.get_inv(), prec_mat_curr);
+}
+
+}
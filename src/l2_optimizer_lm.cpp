@@ -0,0 +1,162 @@
+//
+/*
+File: l2_optimizer_lm.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/l2_optimizer_lm.hpp"
+#include "../include/ggm_inversion_bits/krylov.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cmath>
+
+namespace ginv {
+
+std::shared_ptr<SolverBase> L2OptimizerLM::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<L2OptimizerLM> solver = std::make_shared<L2OptimizerLM>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat, arma::mat> L2OptimizerLM::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    arma::mat prec_mat_curr = prec_mat_init;
+    double deriv_norm_init = 0.0;
+    
+    CholFactor chol_factor, chol_factor_trial;
+    _factorize_init(chol_factor, prec_mat_curr);
+    
+    // Scale of J^T J, from J((i,i),(i,i)) = - Sigma_ii^2
+    double lambda_scale = pow(chol_factor.get_inv().diag().max(), 4);
+    double lambda = init_lambda_rel * lambda_scale;
+    double lambda_growth = 2.0;
+    
+    bool recompute = true;
+    bool use_dense = (_pattern->get_no_free() <= max_no_free_dense);
+    arma::vec res_vec, jac_trans_res_vec;
+    arma::mat jacobian, jac_trans_jac;
+    double obj_func_curr = 0.0;
+    for (size_t i=0; i<no_opt_steps; i++) {
+        const arma::mat &cov_mat_curr = chol_factor.get_inv();
+        
+        // Log if needed
+        _log_progress_if_needed(options, i, no_opt_steps, cov_mat_curr, cov_mat_true, prec_mat_curr);
+        
+        // Write if needed
+        _write_progress_if_needed(options, i, prec_mat_curr, cov_mat_curr, cov_mat_true);
+        
+        // Residuals and Jacobian only change if the last step was accepted
+        if (recompute) {
+            res_vec = free_mat_to_vec(cov_mat_curr - cov_mat_true);
+            obj_func_curr = arma::dot(res_vec, res_vec);
+            if (use_dense) {
+                jacobian = get_res_jacobian(cov_mat_curr);
+                jac_trans_jac = jacobian.t() * jacobian;
+                jac_trans_res_vec = jacobian.t() * res_vec;
+            } else {
+                jac_trans_res_vec = get_res_jacobian_trans_vec_prod(cov_mat_curr, res_vec);
+            }
+            recompute = false;
+        }
+        
+        // Check convergence; the derivs are 2 J^T r
+        double max_abs_deriv = 2.0 * arma::max(arma::abs(jac_trans_res_vec));
+        if (max_abs_deriv < conv_max_abs_deriv) {
+            if (options.log_progress) {
+                std::string header = _get_log_header(options, i, no_opt_steps);
+                spdlog::info(header + "Converged: max absolute deriv: {:e} is less than limit: {:e}", max_abs_deriv, conv_max_abs_deriv);
+            }
+            break;
+        }
+        
+        if (lambda > max_lambda_rel * lambda_scale) {
+            if (options.log_progress) {
+                std::string header = _get_log_header(options, i, no_opt_steps);
+                spdlog::info(header + "Stopping: damping: {:e} is too large", lambda);
+            }
+            break;
+        }
+        
+        // Damped Gauss-Newton step
+        arma::vec update_vec;
+        if (use_dense) {
+            arma::mat sys_mat = jac_trans_jac;
+            sys_mat.diag() += lambda;
+            if (!arma::solve(update_vec, sys_mat, - jac_trans_res_vec, arma::solve_opts::likely_sympd)) {
+                lambda *= lambda_growth;
+                lambda_growth *= 2.0;
+                continue;
+            }
+        } else {
+            double deriv_norm = arma::norm(jac_trans_res_vec);
+            if (i == 0) {
+                deriv_norm_init = deriv_norm;
+            }
+            double cg_tol = std::min(cg_max_rel_tol, sqrt(deriv_norm / deriv_norm_init)) * deriv_norm;
+            
+            MatVecProd sys_vec_prod = [&](const arma::vec &vec) {
+                arma::vec prod = get_res_jacobian_trans_vec_prod(cov_mat_curr, get_res_jacobian_vec_prod(cov_mat_curr, vec));
+                prod += lambda * vec;
+                return prod;
+            };
+            update_vec = solve_cg_truncated(sys_vec_prod, - jac_trans_res_vec, cg_tol, cg_max_no_steps);
+        }
+        
+        // Reduction predicted by the linearized residuals
+        arma::vec res_vec_lin = res_vec;
+        if (use_dense) {
+            res_vec_lin += jacobian * update_vec;
+        } else {
+            res_vec_lin += get_res_jacobian_vec_prod(cov_mat_curr, update_vec);
+        }
+        double pred_red = obj_func_curr - arma::dot(res_vec_lin, res_vec_lin);
+        
+        // Actual reduction; steps that leave the PD cone count as no reduction
+        arma::mat prec_mat_trial = prec_mat_curr + free_vec_to_mat(update_vec);
+        double ratio = 0.0;
+        if (pred_red > 0 && chol_factor_trial.factorize(prec_mat_trial)) {
+            double obj_func_trial = get_obj_func_val(chol_factor_trial.get_inv(), cov_mat_true);
+            ratio = (obj_func_curr - obj_func_trial) / pred_red;
+        }
+        
+        // Accept and decrease the damping, or reject and increase it
+        if (ratio > 0) {
+            prec_mat_curr = prec_mat_trial;
+            std::swap(chol_factor, chol_factor_trial);
+            recompute = true;
+            lambda *= std::max(1.0 / 3.0, 1.0 - pow(2.0 * ratio - 1.0, 3));
+            lambda_growth = 2.0;
+        } else {
+            lambda *= lambda_growth;
+            lambda_growth *= 2.0;
+        }
+    }
+    
+    return std::make_pair(chol_factor.get_inv(), prec_mat_curr);
+}
+
+}
@@ -0,0 +1,102 @@
+//
+/*
+File: l2_optimizer_newton_cg.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/l2_optimizer_newton_cg.hpp"
+#include "../include/ggm_inversion_bits/krylov.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace ginv {
+
+std::shared_ptr<SolverBase> L2OptimizerNewtonCG::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<L2OptimizerNewtonCG> solver = std::make_shared<L2OptimizerNewtonCG>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat, arma::mat> L2OptimizerNewtonCG::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    arma::mat prec_mat_curr = prec_mat_init;
+    double deriv_norm_init = 0.0;
+    
+    Workspace workspace(_dim);
+    CholFactor &chol_factor = workspace.chol_factor;
+    _factorize_init(chol_factor, prec_mat_curr);
+    
+    for (size_t i=0; i<no_opt_steps; i++) {
+        const arma::mat &cov_mat_curr = chol_factor.get_inv();
+        
+        // Log if needed
+        _log_progress_if_needed(options, i, no_opt_steps, cov_mat_curr, cov_mat_true, prec_mat_curr);
+        
+        // Write if needed
+        _write_progress_if_needed(options, i, prec_mat_curr, cov_mat_curr, cov_mat_true);
+        
+        // Check convergence
+        arma::vec deriv_vec = get_deriv_vec(cov_mat_curr, cov_mat_true);
+        double max_abs_deriv = arma::max(arma::abs(deriv_vec));
+        if (max_abs_deriv < conv_max_abs_deriv) {
+            if (options.log_progress) {
+                std::string header = _get_log_header(options, i, no_opt_steps);
+                spdlog::info(header + "Converged: max absolute deriv: {:e} is less than limit: {:e}", max_abs_deriv, conv_max_abs_deriv);
+            }
+            break;
+        }
+        
+        // Newton step from truncated CG
+        double deriv_norm = arma::norm(deriv_vec);
+        if (i == 0) {
+            deriv_norm_init = deriv_norm;
+        }
+        double cg_tol = std::min(cg_max_rel_tol, sqrt(deriv_norm / deriv_norm_init)) * deriv_norm;
+        
+        MatVecProd hessian_vec_prod = [&](const arma::vec &vec) {
+            return get_hessian_vec_prod(cov_mat_curr, cov_mat_true, vec);
+        };
+        arma::vec update_vec = solve_cg_truncated(hessian_vec_prod, - deriv_vec, cg_tol, cg_max_no_steps);
+        
+        // Armijo backtracking from the full Newton step; the line search leaves the accepted iterate factorized
+        free_vec_to_mat(update_vec, workspace.update_mat);
+        workspace.prec_mat_prev = prec_mat_curr;
+        double obj_func_0 = get_obj_func_val(cov_mat_curr, cov_mat_true);
+        double slope = arma::dot(deriv_vec, update_vec);
+        double step_size = _get_step_size_line_search(cov_mat_true, obj_func_0, slope, 1.0, armijo_c, 0.0, max_no_backtracks, prec_mat_curr, workspace);
+        if (step_size == 0.0) {
+            if (options.log_progress) {
+                std::string header = _get_log_header(options, i, no_opt_steps);
+                spdlog::info(header + "Stopping: line search failed to find an acceptable step");
+            }
+            break;
+        }
+    }
+    
+    return std::make_pair(chol_factor.get_inv(), prec_mat_curr);
+}
+
+}
@@ -41,7 +41,15 @@ double optim_obj_func(const arma::vec &prec_mat_vec, arma::vec *deriv_vec, void*
     arma::mat cov_mat_true = input->cov_mat_true;
     
     arma::mat prec_mat_curr = optimizer->free_vec_to_mat(prec_mat_vec);
-    arma::mat cov_mat_curr = arma::inv(prec_mat_curr);
+    
+    // Outside the PD cone the external optimizer still needs a value, so fall back to the general inverse
+    CholFactor chol_factor;
+    arma::mat cov_mat_curr;
+    if (chol_factor.factorize(prec_mat_curr)) {
+        cov_mat_curr = chol_factor.get_inv();
+    } else {
+        cov_mat_curr = arma::inv(prec_mat_curr);
+    }
     
     // Obj func val
     double obj_func_val = optimizer->get_obj_func_val(cov_mat_curr, cov_mat_true);
@@ -55,7 +63,13 @@ double optim_obj_func(const arma::vec &prec_mat_vec, arma::vec *deriv_vec, void*
     return obj_func_val;
 }
 
-std::pair<arma::mat,arma::mat> L2OptimizerOptim::solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+std::shared_ptr<SolverBase> L2OptimizerOptim::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<L2OptimizerOptim> solver = std::make_shared<L2OptimizerOptim>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat,arma::mat> L2OptimizerOptim::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
     
     // Init
     arma::vec prec_mat_vec = free_mat_to_vec(prec_mat_init);
@@ -81,6 +95,11 @@ std::pair<arma::mat,arma::mat> L2OptimizerOptim::solve(const arma::mat &cov_mat_
         success = optim::gd(prec_mat_vec, optim_obj_func, input, settings);
     }
     
+    arma::mat prec_mat_sol = free_vec_to_mat(prec_mat_vec);
+    CholFactor chol_factor;
+    bool is_pd = chol_factor.factorize(prec_mat_sol);
+    arma::mat cov_mat_sol = is_pd ? chol_factor.get_inv() : arma::inv(prec_mat_sol);
+    
     // Must succeed
     if (log_result) {
         
@@ -92,17 +111,23 @@ std::pair<arma::mat,arma::mat> L2OptimizerOptim::solve(const arma::mat &cov_mat_
         }
         spdlog::info(log_header + "Obj func value: {:f}", settings.opt_fn_value);
         spdlog::info(log_header + "Error value: {:f}", settings.opt_error_value);
+        if (!is_pd) {
+            spdlog::info(log_header + "Prec mat is not positive definite");
+        }
         spdlog::info(log_header + "Prec mat:");
-        _log_mat_info(free_vec_to_mat(prec_mat_vec), log_header);
+        _log_mat_info(prec_mat_sol, log_header);
         spdlog::info(log_header + "Cov mat:");
-        _log_mat_info(arma::inv(free_vec_to_mat(prec_mat_vec)), log_header);
+        _log_mat_info(cov_mat_sol, log_header);
     }
     
     // Clean up!
     delete input;
     
-    arma::mat prec_mat_sol = free_vec_to_mat(prec_mat_vec);
-    return std::make_pair(arma::inv(prec_mat_sol), prec_mat_sol);
+    return std::make_pair(cov_mat_sol, prec_mat_sol);
+}
+
+bool L2OptimizerOptim::_supports_concurrent_solves() const {
+    return false;
 }
 
 void L2OptimizerOptim::set_alg_adam(double lr) {
@@ -0,0 +1,144 @@
+//
+/*
+File: l2_optimizer_trust_region.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/l2_optimizer_trust_region.hpp"
+#include "../include/ggm_inversion_bits/krylov.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace ginv {
+
+std::shared_ptr<SolverBase> L2OptimizerTrustRegion::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<L2OptimizerTrustRegion> solver = std::make_shared<L2OptimizerTrustRegion>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat, arma::mat> L2OptimizerTrustRegion::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    arma::mat prec_mat_curr = prec_mat_init;
+    double deriv_norm_init = 0.0;
+    
+    CholFactor chol_factor, chol_factor_trial;
+    _factorize_init(chol_factor, prec_mat_curr);
+    
+    double radius = init_radius;
+    if (radius <= 0.0) {
+        radius = 0.1 * arma::norm(free_mat_to_vec(prec_mat_curr));
+    }
+    
+    bool recompute = true;
+    arma::vec deriv_vec;
+    arma::mat hessian;
+    double obj_func_curr = 0.0;
+    bool use_hessian = (_pattern->get_no_free() <= max_no_free_hessian);
+    for (size_t i=0; i<no_opt_steps; i++) {
+        const arma::mat &cov_mat_curr = chol_factor.get_inv();
+        
+        // Log if needed
+        _log_progress_if_needed(options, i, no_opt_steps, cov_mat_curr, cov_mat_true, prec_mat_curr);
+        
+        // Write if needed
+        _write_progress_if_needed(options, i, prec_mat_curr, cov_mat_curr, cov_mat_true);
+        
+        // Derivs and Hessian only change if the last step was accepted
+        if (recompute) {
+            deriv_vec = get_deriv_vec(cov_mat_curr, cov_mat_true);
+            obj_func_curr = get_obj_func_val(cov_mat_curr, cov_mat_true);
+            if (use_hessian) {
+                hessian = get_hessian(cov_mat_curr, cov_mat_true);
+            }
+            recompute = false;
+        }
+        
+        // Check convergence
+        double max_abs_deriv = arma::max(arma::abs(deriv_vec));
+        if (max_abs_deriv < conv_max_abs_deriv) {
+            if (options.log_progress) {
+                std::string header = _get_log_header(options, i, no_opt_steps);
+                spdlog::info(header + "Converged: max absolute deriv: {:e} is less than limit: {:e}", max_abs_deriv, conv_max_abs_deriv);
+            }
+            break;
+        }
+        
+        if (radius < min_rel_radius * arma::norm(free_mat_to_vec(prec_mat_curr))) {
+            if (options.log_progress) {
+                std::string header = _get_log_header(options, i, no_opt_steps);
+                spdlog::info(header + "Stopping: trust region radius: {:e} is too small", radius);
+            }
+            break;
+        }
+        
+        // Subproblem by Steihaug-Toint CG
+        double deriv_norm = arma::norm(deriv_vec);
+        if (i == 0) {
+            deriv_norm_init = deriv_norm;
+        }
+        double cg_tol = std::min(cg_max_rel_tol, sqrt(deriv_norm / deriv_norm_init)) * deriv_norm;
+        
+        MatVecProd hessian_vec_prod = [&](const arma::vec &vec) -> arma::vec {
+            if (use_hessian) {
+                return hessian * vec;
+            }
+            return get_hessian_vec_prod(cov_mat_curr, cov_mat_true, vec);
+        };
+        bool on_boundary = false;
+        arma::vec update_vec = solve_cg_steihaug(hessian_vec_prod, - deriv_vec, radius, cg_tol, cg_max_no_steps, on_boundary);
+        
+        // Reduction predicted by the quadratic model
+        double pred_red = - arma::dot(deriv_vec, update_vec) - 0.5 * arma::dot(update_vec, hessian_vec_prod(update_vec));
+        
+        // Actual reduction; steps that leave the PD cone count as no reduction
+        arma::mat prec_mat_trial = prec_mat_curr + free_vec_to_mat(update_vec);
+        double ratio = 0.0;
+        if (pred_red > 0 && chol_factor_trial.factorize(prec_mat_trial)) {
+            double obj_func_trial = get_obj_func_val(chol_factor_trial.get_inv(), cov_mat_true);
+            ratio = (obj_func_curr - obj_func_trial) / pred_red;
+        }
+        
+        // Update the radius
+        double update_norm = arma::norm(update_vec);
+        if (ratio < 0.25) {
+            radius = 0.25 * update_norm;
+        } else if (ratio > 0.75 && on_boundary) {
+            radius = std::min(2.0 * radius, max_radius);
+        }
+        
+        // Accept or reject
+        if (ratio > accept_ratio) {
+            prec_mat_curr = prec_mat_trial;
+            std::swap(chol_factor, chol_factor_trial);
+            recompute = true;
+        }
+    }
+    
+    return std::make_pair(chol_factor.get_inv(), prec_mat_curr);
+}
+
+}
@@ -0,0 +1,320 @@
+//
+/*
+File: maxdet_newton.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/maxdet_newton.hpp"
+#include "../include/ggm_inversion_bits/krylov.hpp"
+#include "../include/ggm_inversion_bits/helpers.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace ginv {
+
+std::shared_ptr<SolverBase> MaxDetNewton::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<MaxDetNewton> solver = std::make_shared<MaxDetNewton>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+void MaxDetNewton::_gather_sym(const arma::mat &mat, arma::vec &vec) const {
+    vec.set_size(_pattern->free_offsets.size());
+    const double *mat_mem = mat.memptr();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        double mult = (_pattern->free_rows[s] == _pattern->free_cols[s]) ? 1.0 : 2.0;
+        vec(s) = mult * mat_mem[_pattern->free_offsets[s]];
+    }
+}
+
+double MaxDetNewton::get_obj_func_val(const CholFactor &chol_factor, const arma::mat &prec_mat, const arma::mat &cov_mat_true) const {
+    double trace = 0.0;
+    const double *prec_mem = prec_mat.memptr();
+    const double *cov_true_mem = cov_mat_true.memptr();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        double mult = (_pattern->free_rows[s] == _pattern->free_cols[s]) ? 1.0 : 2.0;
+        trace += mult * prec_mem[_pattern->free_offsets[s]] * cov_true_mem[_pattern->free_offsets[s]];
+    }
+    return - chol_factor.get_log_det() + trace;
+}
+
+arma::vec MaxDetNewton::get_deriv_vec(const arma::mat &cov_mat_curr, const arma::mat &cov_mat_true) const {
+    arma::vec deriv_vec;
+    _gather_sym(cov_mat_true - cov_mat_curr, deriv_vec);
+    return deriv_vec;
+}
+
+arma::vec MaxDetNewton::get_hessian_vec_prod(const arma::mat &cov_mat_curr, const arma::vec &vec) const {
+    arma::mat prod_mat = cov_mat_curr * free_vec_to_mat(vec) * cov_mat_curr;
+    arma::vec hess_vec;
+    _gather_sym(prod_mat, hess_vec);
+    return hess_vec;
+}
+
+std::pair<arma::mat, arma::mat> MaxDetNewton::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    for (auto i=0; i<_dim; i++) {
+        if (!_pattern->check_free(i, i)) {
+            throw std::invalid_argument("MaxDetNewton requires all diagonal elements to be free");
+        }
+    }
+    
+    // Start from a PD prec mat with the pattern
+    CholFactor chol_factor;
+    arma::mat prec_mat_curr;
+    if (prec_mat_init.n_elem > 0) {
+        prec_mat_curr = zero_non_free_elements(prec_mat_init);
+    }
+    if (prec_mat_curr.n_elem == 0 || !chol_factor.factorize(prec_mat_curr)) {
+        prec_mat_curr = arma::diagmat(1.0 / cov_mat_true.diag());
+        chol_factor.factorize(prec_mat_curr);
+    }
+    
+    double deriv_norm_init = 0.0;
+    CholFactor chol_factor_trial;
+    arma::mat prec_mat_trial;
+    for (auto i=0; i<max_no_opt_steps; i++) {
+        const arma::mat &cov_mat_curr = chol_factor.get_inv();
+        
+        arma::vec deriv_vec = get_deriv_vec(cov_mat_curr, cov_mat_true);
+        double max_abs_err = 0.0;
+        for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+            max_abs_err = std::max(max_abs_err, std::abs(cov_mat_curr(_pattern->free_offsets[s]) - cov_mat_true(_pattern->free_offsets[s])));
+        }
+        
+        // Log
+        if (options.log_progress && i % options.log_interval == 0) {
+            spdlog::info(_get_log_header(options, i, max_no_opt_steps) + "max abs err of cov mat: {:e}", max_abs_err);
+        }
+        
+        // Write
+        if (options.write_progress && i % options.write_interval == 0) {
+            assert (options.write_dir != "");
+            write_mat(options.write_dir + "prec_mat.txt", i, i!=0, prec_mat_curr);
+            write_mat(options.write_dir + "cov_mat.txt", i, i!=0, cov_mat_curr);
+        }
+        
+        if (max_abs_err < conv_max_abs_err) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, i, max_no_opt_steps) + "Converged: max abs err of cov mat: {:e} is less than limit: {:e}", max_abs_err, conv_max_abs_err);
+            }
+            break;
+        }
+        
+        // Newton step from CG; the Hessian is PD
+        double deriv_norm = arma::norm(deriv_vec);
+        if (i == 0) {
+            deriv_norm_init = deriv_norm;
+        }
+        double cg_tol = std::min(cg_max_rel_tol, sqrt(deriv_norm / deriv_norm_init)) * deriv_norm;
+        
+        MatVecProd hessian_vec_prod = [&](const arma::vec &vec) {
+            return get_hessian_vec_prod(cov_mat_curr, vec);
+        };
+        arma::vec update_vec = solve_cg_truncated(hessian_vec_prod, - deriv_vec, cg_tol, cg_max_no_steps);
+        arma::mat update_mat = free_vec_to_mat(update_vec);
+        
+        // Backtrack until PD and Armijo
+        double obj_func_0 = get_obj_func_val(chol_factor, prec_mat_curr, cov_mat_true);
+        double slope = arma::dot(deriv_vec, update_vec);
+        double step_size = 1.0;
+        bool accepted = false;
+        for (auto k=0; k<max_no_backtracks; k++) {
+            prec_mat_trial = prec_mat_curr + step_size * update_mat;
+            if (chol_factor_trial.factorize(prec_mat_trial)) {
+                double obj_func = get_obj_func_val(chol_factor_trial, prec_mat_trial, cov_mat_true);
+                if (obj_func <= obj_func_0 + armijo_c * step_size * slope) {
+                    accepted = true;
+                    break;
+                }
+            }
+            step_size *= 0.5;
+        }
+        if (!accepted) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, i, max_no_opt_steps) + "Stopping: line search failed to find an acceptable step");
+            }
+            break;
+        }
+        
+        std::swap(prec_mat_curr, prec_mat_trial);
+        std::swap(chol_factor, chol_factor_trial);
+    }
+    
+    return std::make_pair(chol_factor.get_inv(), prec_mat_curr);
+}
+
+double MaxDetNewton::get_obj_func_val(const SparseCholFactor &chol_factor, const arma::vec &prec_vec, const arma::vec &cov_vec_true) const {
+    double trace = 0.0;
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        double mult = (_pattern->free_rows[s] == _pattern->free_cols[s]) ? 1.0 : 2.0;
+        trace += mult * prec_vec(s) * cov_vec_true(s);
+    }
+    return - chol_factor.get_log_det() + trace;
+}
+
+arma::vec MaxDetNewton::get_cov_vec(const SparseCholFactor &chol_factor) const {
+    
+    // Sigma on the pattern of L, which contains the free pairs
+    std::vector<double> selected_inv;
+    chol_factor.get_selected_inv(selected_inv);
+    
+    arma::vec cov_vec(_pattern->free_offsets.size());
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        cov_vec(s) = chol_factor.get_selected_inv_elem(selected_inv, _pattern->free_rows[s], _pattern->free_cols[s]);
+    }
+    return cov_vec;
+}
+
+arma::vec MaxDetNewton::get_hessian_vec_prod(const SparseCholFactor &chol_factor, const arma::vec &vec) const {
+    arma::sp_mat update_mat = free_vec_to_sp_mat(vec);
+    
+    arma::vec hess_vec(_pattern->free_offsets.size());
+    arma::vec col(_dim), prod(_dim);
+    for (auto j=0; j<_dim; j++) {
+        
+        // Col j of Sigma dB Sigma
+        col.zeros();
+        col(j) = 1.0;
+        chol_factor.solve_in_place(col);
+        prod = update_mat * col;
+        chol_factor.solve_in_place(prod);
+        
+        hess_vec(_pattern->get_free_slot(j, j)) = prod(j);
+        for (auto s=_pattern->adj_ptr[j]; s<_pattern->adj_ptr[j+1]; s++) {
+            int i = _pattern->adj_idx[s];
+            if (i > j) {
+                hess_vec(_pattern->get_free_slot(i, j)) = 2.0 * prod(i);
+            }
+        }
+    }
+    return hess_vec;
+}
+
+std::pair<arma::sp_mat, arma::sp_mat> MaxDetNewton::solve_sparse(const arma::sp_mat &cov_mat_true, const arma::sp_mat &prec_mat_init) const {
+    
+    for (auto i=0; i<_dim; i++) {
+        if (!_pattern->check_free(i, i)) {
+            throw std::invalid_argument("MaxDetNewton requires all diagonal elements to be free");
+        }
+    }
+    if ((int)cov_mat_true.n_rows != _dim || (int)cov_mat_true.n_cols != _dim) {
+        throw std::invalid_argument("Cov mat has the wrong size");
+    }
+    
+    arma::vec cov_vec_true = free_sp_mat_to_vec(cov_mat_true);
+    
+    // Symbolic analysis is cached on the pattern; the trial factor and copies of this solver share it
+    SparseCholFactor chol_factor;
+    chol_factor.analyze(*_pattern);
+    SparseCholFactor chol_factor_trial = chol_factor;
+    
+    // Start from a PD prec mat with the pattern
+    arma::vec prec_vec_curr;
+    if (prec_mat_init.n_nonzero > 0) {
+        prec_vec_curr = free_sp_mat_to_vec(prec_mat_init);
+    }
+    if (prec_vec_curr.n_elem == 0 || !chol_factor.factorize(free_vec_to_sp_mat(prec_vec_curr))) {
+        prec_vec_curr.zeros(_pattern->free_offsets.size());
+        for (auto i=0; i<_dim; i++) {
+            prec_vec_curr(_pattern->get_free_slot(i, i)) = 1.0 / cov_mat_true(i, i);
+        }
+        chol_factor.factorize(free_vec_to_sp_mat(prec_vec_curr));
+    }
+    
+    if (options.log_progress) {
+        spdlog::info(log_header + "Sparse Cholesky factor has {} nonzeros in {} supernodes", chol_factor.get_no_nonzeros(), chol_factor.get_symbolic()->get_no_supernodes());
+    }
+    
+    double deriv_norm_init = 0.0;
+    arma::vec cov_vec_curr, prec_vec_trial;
+    for (auto i=0; i<max_no_opt_steps; i++) {
+        cov_vec_curr = get_cov_vec(chol_factor);
+        
+        arma::vec deriv_vec = cov_vec_true - cov_vec_curr;
+        double max_abs_err = arma::abs(deriv_vec).max();
+        for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+            if (_pattern->free_rows[s] != _pattern->free_cols[s]) {
+                deriv_vec(s) *= 2.0;
+            }
+        }
+        
+        // Log
+        if (options.log_progress && i % options.log_interval == 0) {
+            spdlog::info(_get_log_header(options, i, max_no_opt_steps) + "max abs err of cov mat: {:e}", max_abs_err);
+        }
+        
+        if (max_abs_err < conv_max_abs_err) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, i, max_no_opt_steps) + "Converged: max abs err of cov mat: {:e} is less than limit: {:e}", max_abs_err, conv_max_abs_err);
+            }
+            break;
+        }
+        
+        // Newton step from CG; the Hessian is PD
+        double deriv_norm = arma::norm(deriv_vec);
+        if (i == 0) {
+            deriv_norm_init = deriv_norm;
+        }
+        double cg_tol = std::min(cg_max_rel_tol, sqrt(deriv_norm / deriv_norm_init)) * deriv_norm;
+        
+        MatVecProd hessian_vec_prod = [&](const arma::vec &vec) {
+            return get_hessian_vec_prod(chol_factor, vec);
+        };
+        arma::vec update_vec = solve_cg_truncated(hessian_vec_prod, - deriv_vec, cg_tol, cg_max_no_steps);
+        
+        // Backtrack until PD and Armijo
+        double obj_func_0 = get_obj_func_val(chol_factor, prec_vec_curr, cov_vec_true);
+        double slope = arma::dot(deriv_vec, update_vec);
+        double step_size = 1.0;
+        bool accepted = false;
+        for (auto k=0; k<max_no_backtracks; k++) {
+            prec_vec_trial = prec_vec_curr + step_size * update_vec;
+            if (chol_factor_trial.factorize(free_vec_to_sp_mat(prec_vec_trial))) {
+                double obj_func = get_obj_func_val(chol_factor_trial, prec_vec_trial, cov_vec_true);
+                if (obj_func <= obj_func_0 + armijo_c * step_size * slope) {
+                    accepted = true;
+                    break;
+                }
+            }
+            step_size *= 0.5;
+        }
+        if (!accepted) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, i, max_no_opt_steps) + "Stopping: line search failed to find an acceptable step");
+            }
+            break;
+        }
+        
+        std::swap(prec_vec_curr, prec_vec_trial);
+        std::swap(chol_factor, chol_factor_trial);
+    }
+    
+    cov_vec_curr = get_cov_vec(chol_factor);
+    return std::make_pair(free_vec_to_sp_mat(cov_vec_curr), free_vec_to_sp_mat(prec_vec_curr));
+}
+
+}
@@ -0,0 +1,201 @@
+//
+/*
+File: root_finding_continuation.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/root_finding_continuation.hpp"
+#include "../include/ggm_inversion_bits/chol_factor.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace ginv {
+
+std::shared_ptr<SolverBase> RootFindingContinuation::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<RootFindingContinuation> solver = std::make_shared<RootFindingContinuation>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+void RootFindingContinuation::_apply_update(const arma::vec &update_vec, double step_size, arma::mat &prec_mat_curr, arma::mat &cov_mat_curr) const {
+    int no_free = _pattern->get_no_free();
+    int no_dofs = update_vec.n_elem;
+    
+    prec_mat_curr += step_size * free_vec_to_mat(update_vec.head(no_free));
+    if (no_dofs > no_free) {
+        cov_mat_curr += step_size * non_free_vec_to_mat(update_vec.tail(no_dofs - no_free));
+    }
+}
+
+void RootFindingContinuation::_set_free_cov(const arma::vec &cov_vec, arma::mat &cov_mat_curr) const {
+    double *cov_mem = cov_mat_curr.memptr();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        cov_mem[_pattern->free_offsets[s]] = cov_vec(s);
+        cov_mem[_pattern->free_offsets_trans[s]] = cov_vec(s);
+    }
+}
+
+std::pair<arma::mat,arma::mat> RootFindingContinuation::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    for (auto i=0; i<_dim; i++) {
+        if (!_pattern->check_free(i, i)) {
+            throw std::invalid_argument("RootFindingContinuation requires all diagonal elements to be free");
+        }
+        if (cov_mat_true(i,i) <= 0) {
+            throw std::invalid_argument("Target cov mat is not positive definite!");
+        }
+    }
+    
+    // Path of the free elements of Sigma: S(t) = diag(S) + t (S - diag(S))
+    arma::vec cov_vec_true = free_mat_to_vec(cov_mat_true);
+    arma::vec cov_vec_diag = cov_vec_true;
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        if (_pattern->free_rows[s] != _pattern->free_cols[s]) {
+            cov_vec_diag(s) = 0.0;
+        }
+    }
+    arma::vec cov_vec_deriv = cov_vec_true - cov_vec_diag;
+    arma::mat cov_mat_deriv = free_vec_to_mat(cov_vec_deriv);
+    
+    // Exact solution at t = 0
+    arma::mat prec_mat_curr = arma::diagmat(1.0 / cov_mat_true.diag());
+    arma::mat cov_mat_curr = arma::diagmat(cov_mat_true.diag());
+    
+    Workspace workspace(_dim, (_dim * (_dim + 1)) / 2);
+    arma::vec &residuals = workspace.residuals;
+    arma::vec tangent_vec, update_vec;
+    arma::mat prec_mat_prev, cov_mat_prev;
+    LUFactor lu_factor;
+    CholFactor chol_factor;
+    
+    double t = 0.0;
+    double step_size = std::min(init_step_size, 1.0);
+    int step = 0;
+    for (; step<max_no_continuation_steps && t < 1.0; step++) {
+        
+        // One factorization per step, at the current point
+        if (!_factorize_jacobian(prec_mat_curr, cov_mat_curr, lu_factor)) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, step, max_no_continuation_steps) + "Stopping: Jacobian is singular at t: {:f}", t);
+            }
+            return std::make_pair(cov_mat_curr, prec_mat_curr);
+        }
+        
+        // Tangent: J dx/dt = - dF/dt, with dF/dt = upper_tri(B dSigma/dt)
+        upper_tri_to_vec(prec_mat_curr * cov_mat_deriv, workspace.residuals);
+        residuals *= -1.0;
+        _solve_lu(lu_factor, residuals, tangent_vec);
+        
+        prec_mat_prev = prec_mat_curr;
+        cov_mat_prev = cov_mat_curr;
+        
+        bool accepted = false;
+        int no_corrector_steps = 0;
+        while (!accepted) {
+            double t_next = std::min(t + step_size, 1.0);
+            
+            // Predictor
+            _apply_update(tangent_vec, t_next - t, prec_mat_curr, cov_mat_curr);
+            _set_free_cov(cov_vec_diag + t_next * cov_vec_deriv, cov_mat_curr);
+            
+            // Chord corrector with the same factorization; stop if not contracting
+            double max_abs_res_prev = std::numeric_limits<double>::infinity();
+            for (no_corrector_steps=0; no_corrector_steps<=max_no_corrector_steps; no_corrector_steps++) {
+                get_residuals(prec_mat_curr, cov_mat_curr, residuals, workspace.prod_mat);
+                double max_abs_res = arma::abs(residuals).max();
+                if (!std::isfinite(max_abs_res) || max_abs_res >= max_abs_res_prev) {
+                    break;
+                }
+                if (max_abs_res < corrector_max_abs_res) {
+                    accepted = chol_factor.factorize(prec_mat_curr);
+                    break;
+                }
+                if (no_corrector_steps == max_no_corrector_steps) {
+                    break;
+                }
+                max_abs_res_prev = max_abs_res;
+                
+                residuals *= -1.0;
+                _solve_lu(lu_factor, residuals, update_vec);
+                _apply_update(update_vec, 1.0, prec_mat_curr, cov_mat_curr);
+            }
+            
+            if (accepted) {
+                t = t_next;
+                break;
+            }
+            
+            // Reject
+            prec_mat_curr = prec_mat_prev;
+            cov_mat_curr = cov_mat_prev;
+            step_size *= 0.5;
+            if (step_size < min_step_size) {
+                if (options.log_progress) {
+                    spdlog::info(_get_log_header(options, step, max_no_continuation_steps) + "Stopping: step size: {:e} is less than limit: {:e} at t: {:f}", step_size, min_step_size, t);
+                }
+                return std::make_pair(cov_mat_curr, prec_mat_curr);
+            }
+        }
+        
+        // Log
+        if (options.log_progress && step % options.log_interval == 0) {
+            spdlog::info(_get_log_header(options, step, max_no_continuation_steps) + "t: {:f} step size: {:e} corrector steps: {:d}", t, step_size, no_corrector_steps);
+        }
+        
+        // Write
+        _write_progress_if_needed(options, step, prec_mat_curr, cov_mat_curr);
+        
+        step_size *= step_size_growth;
+    }
+    
+    if (t < 1.0) {
+        if (options.log_progress) {
+            spdlog::info(_get_log_header(options, step, max_no_continuation_steps) + "Stopping: max no continuation steps reached at t: {:f}", t);
+        }
+        return std::make_pair(cov_mat_curr, prec_mat_curr);
+    }
+    
+    // Newton at the full target, to the convergence criteria
+    for (auto i=0; i<conv_max_no_opt_steps; i++) {
+        get_residuals(prec_mat_curr, cov_mat_curr, residuals, workspace.prod_mat);
+        if (_check_convergence(options, i, conv_max_no_opt_steps, residuals)) {
+            break;
+        }
+        if (!_factorize_jacobian(prec_mat_curr, cov_mat_curr, lu_factor)) {
+            if (options.log_progress) {
+                spdlog::info(_get_log_header(options, i, conv_max_no_opt_steps) + "Stopping: Jacobian is singular");
+            }
+            break;
+        }
+        residuals *= -1.0;
+        _solve_lu(lu_factor, residuals, update_vec);
+        _apply_update(update_vec, 1.0, prec_mat_curr, cov_mat_curr);
+    }
+    
+    return std::make_pair(cov_mat_curr, prec_mat_curr);
+}
+
+};
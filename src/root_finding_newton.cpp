@@ -29,12 +29,28 @@ SOFTWARE.
 
 #include "../include/ggm_inversion_bits/root_finding_newton.hpp"
 #include "../include/ggm_inversion_bits/helpers.hpp"
+#include "../include/ggm_inversion_bits/krylov.hpp"
 
 #include <spdlog/spdlog.h>
 
+#include <array>
+
 namespace ginv {
 
-void RootFindingNewton::_log_progress_if_needed(Options options, int opt_step, int no_opt_steps, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_targets, const arma::mat &prec_mat_curr) const {
+RootFindingNewton::Workspace::Workspace(int dim, int no_dofs) {
+    prod_mat.zeros(dim, dim);
+    update_mat_b.zeros(dim, dim);
+    update_mat_sigma.zeros(dim, dim);
+    prec_mat_trial.zeros(dim, dim);
+    cov_mat_trial.zeros(dim, dim);
+    residuals.zeros(no_dofs);
+    residuals_trial.zeros(no_dofs);
+    residuals_prev.zeros(no_dofs);
+    update_vec.zeros(no_dofs);
+    step_vec.zeros(no_dofs);
+}
+
+void RootFindingNewton::_log_progress_if_needed(const Options &options, int opt_step, int no_opt_steps, const arma::mat &cov_mat_curr, const arma::mat &cov_mat_targets, const arma::mat &prec_mat_curr) const {
     if (options.log_progress) {
         if (opt_step % options.log_interval == 0) {
             
@@ -49,8 +65,13 @@ void RootFindingNewton::_log_progress_if_needed(Options options, int opt_step, i
             if (options.log_mats) {
                 spdlog::info(header + "Cov mat curr:");
                 _log_mat_info(cov_mat_curr, header);
-                spdlog::info(header + "Inv of current prec mat:");
-                _log_mat_info(arma::inv(prec_mat_curr), header);
+                CholFactor chol_factor;
+                if (chol_factor.factorize(prec_mat_curr)) {
+                    spdlog::info(header + "Inv of current prec mat:");
+                    _log_mat_info(chol_factor.get_inv(), header);
+                } else {
+                    spdlog::info(header + "Current prec mat is not positive definite");
+                }
                 spdlog::info(header + "Prec mat curr:");
                 _log_mat_info(prec_mat_curr, header);
             }
@@ -58,7 +79,7 @@ void RootFindingNewton::_log_progress_if_needed(Options options, int opt_step, i
     }
 }
 
-void RootFindingNewton::_write_progress_if_needed(Options options, int opt_step, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const {
+void RootFindingNewton::_write_progress_if_needed(const Options &options, int opt_step, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const {
     if (options.write_progress) {
         assert (options.write_dir != "");
         
@@ -81,9 +102,15 @@ arma::mat RootFindingNewton::get_i_mat(int k, int l) const {
 }
 
 arma::vec RootFindingNewton::upper_tri_to_vec(const arma::mat &mat) const {
+    arma::vec vec;
+    upper_tri_to_vec(mat, vec);
+    return vec;
+}
+
+void RootFindingNewton::upper_tri_to_vec(const arma::mat &mat, arma::vec &vec) const {
     int no_dofs = (_dim * (_dim + 1) ) / 2;
     
-    arma::vec vec(no_dofs);
+    vec.set_size(no_dofs);
     int x = 0;
     for (auto i=0; i<_dim; i++) {
         for (auto j=i; j<_dim; j++) {
@@ -91,35 +118,114 @@ arma::vec RootFindingNewton::upper_tri_to_vec(const arma::mat &mat) const {
             x++;
         }
     }
+}
+
+int RootFindingNewton::_get_upper_tri_idx(int i, int j) const {
+    return i * _dim - (i * (i - 1)) / 2 + (j - i);
+}
+
+std::shared_ptr<const JacStructure> RootFindingNewton::_get_jac_structure() const {
+    return _pattern->get_derived<JacStructure>([&] {
+        return _build_jac_structure();
+    });
+}
+
+std::shared_ptr<const JacStructure> RootFindingNewton::_build_jac_structure() const {
+    std::shared_ptr<const NonFreeSlots> non_free_slots = _pattern->get_non_free_slots();
+    const std::vector<std::pair<int,int>> &idx_pairs_non_free = non_free_slots->idx_pairs_non_free;
     
-    return vec;
+    // Entries as (col, row, linear idx of source)
+    std::vector<std::array<arma::uword,3>> entries_cov, entries_prec;
+    
+    // Derivs wrt free elements of B: rows k and l of I_kl * Sigma
+    for (auto i_dof=0; i_dof<_pattern->idx_pairs_free.size(); i_dof++) {
+        int k = _pattern->idx_pairs_free.at(i_dof).first;
+        int l = _pattern->idx_pairs_free.at(i_dof).second;
+        
+        for (auto j=k; j<_dim; j++) {
+            entries_cov.push_back({(arma::uword)i_dof, (arma::uword)_get_upper_tri_idx(k, j), (arma::uword)(l + j * _dim)});
+        }
+        if (k != l) {
+            for (auto j=l; j<_dim; j++) {
+                entries_cov.push_back({(arma::uword)i_dof, (arma::uword)_get_upper_tri_idx(l, j), (arma::uword)(k + j * _dim)});
+            }
+        }
+    }
+    
+    // Derivs wrt non-free elements of Sigma: cols k and l of B * I_kl
+    for (auto j_dof=0; j_dof<idx_pairs_non_free.size(); j_dof++) {
+        int i_dof = j_dof + _pattern->idx_pairs_free.size();
+        
+        int k = idx_pairs_non_free.at(j_dof).first;
+        int l = idx_pairs_non_free.at(j_dof).second;
+        
+        for (auto i=0; i<=l; i++) {
+            entries_prec.push_back({(arma::uword)i_dof, (arma::uword)_get_upper_tri_idx(i, l), (arma::uword)(i + k * _dim)});
+        }
+        if (k != l) {
+            for (auto i=0; i<=k; i++) {
+                entries_prec.push_back({(arma::uword)i_dof, (arma::uword)_get_upper_tri_idx(i, k), (arma::uword)(i + l * _dim)});
+            }
+        }
+    }
+    
+    // Column-major order; all cov columns precede all prec columns
+    std::sort(entries_cov.begin(), entries_cov.end());
+    std::sort(entries_prec.begin(), entries_prec.end());
+    
+    std::shared_ptr<JacStructure> jac_structure = std::make_shared<JacStructure>();
+    jac_structure->locations.set_size(2, entries_cov.size() + entries_prec.size());
+    jac_structure->idxs_cov.set_size(entries_cov.size());
+    jac_structure->idxs_prec.set_size(entries_prec.size());
+    for (size_t i=0; i<entries_cov.size(); i++) {
+        jac_structure->locations(0,i) = entries_cov.at(i)[1];
+        jac_structure->locations(1,i) = entries_cov.at(i)[0];
+        jac_structure->idxs_cov(i) = entries_cov.at(i)[2];
+    }
+    for (size_t i=0; i<entries_prec.size(); i++) {
+        jac_structure->locations(0,i+entries_cov.size()) = entries_prec.at(i)[1];
+        jac_structure->locations(1,i+entries_cov.size()) = entries_prec.at(i)[0];
+        jac_structure->idxs_prec(i) = entries_prec.at(i)[2];
+    }
+    
+    return jac_structure;
 }
 
 arma::vec RootFindingNewton::get_residuals(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const {
-    arma::mat tmp = prec_mat_curr*cov_mat_curr - arma::eye(_dim,_dim);
-    return upper_tri_to_vec(tmp);
+    arma::vec residuals;
+    arma::mat prod_mat;
+    get_residuals(prec_mat_curr, cov_mat_curr, residuals, prod_mat);
+    return residuals;
+}
+
+void RootFindingNewton::get_residuals(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, arma::vec &residuals, arma::mat &prod_mat) const {
+    prod_mat = prec_mat_curr * cov_mat_curr;
+    prod_mat.diag() -= 1.0;
+    upper_tri_to_vec(prod_mat, residuals);
 }
 
 arma::mat RootFindingNewton::get_jacobian(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const {
+    std::shared_ptr<const NonFreeSlots> non_free_slots = _pattern->get_non_free_slots();
+    const std::vector<std::pair<int,int>> &idx_pairs_non_free = non_free_slots->idx_pairs_non_free;
     
     int no_dofs = (_dim * (_dim + 1) ) / 2;
     arma::mat jac(no_dofs, no_dofs);
     
     // First: derivs wrt free elements of B
-    for (auto i_dof=0; i_dof<_idx_pairs_free.size(); i_dof++) {
-        int k = _idx_pairs_free.at(i_dof).first;
-        int l = _idx_pairs_free.at(i_dof).second;
+    for (auto i_dof=0; i_dof<_pattern->idx_pairs_free.size(); i_dof++) {
+        int k = _pattern->idx_pairs_free.at(i_dof).first;
+        int l = _pattern->idx_pairs_free.at(i_dof).second;
         
         arma::mat deriv_f_wrt_bkl = get_i_mat(k, l) * cov_mat_curr;
         jac.col(i_dof) = upper_tri_to_vec(deriv_f_wrt_bkl);
     }
     
     // Second: derivs wrt non-free elements of Sigma
-    for (auto j_dof=0; j_dof<_idx_pairs_non_free.size(); j_dof++) {
-        int i_dof = j_dof + _idx_pairs_free.size();
+    for (auto j_dof=0; j_dof<idx_pairs_non_free.size(); j_dof++) {
+        int i_dof = j_dof + _pattern->idx_pairs_free.size();
         
-        int k = _idx_pairs_non_free.at(j_dof).first;
-        int l = _idx_pairs_non_free.at(j_dof).second;
+        int k = idx_pairs_non_free.at(j_dof).first;
+        int l = idx_pairs_non_free.at(j_dof).second;
 
         arma::mat deriv_f_wrt_skl = prec_mat_curr * get_i_mat(k, l);
         jac.col(i_dof) = upper_tri_to_vec(deriv_f_wrt_skl);
@@ -128,13 +234,100 @@ arma::mat RootFindingNewton::get_jacobian(const arma::mat &prec_mat_curr, const
     return jac;
 }
 
-bool RootFindingNewton::_check_convergence(Options options, int opt_step, int no_opt_steps, const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const {
+arma::sp_mat RootFindingNewton::get_jacobian_sparse(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr) const {
+    int no_dofs = (_dim * (_dim + 1) ) / 2;
+    std::shared_ptr<const JacStructure> jac_structure = _get_jac_structure();
+    arma::vec values = arma::join_cols(cov_mat_curr.elem(jac_structure->idxs_cov), prec_mat_curr.elem(jac_structure->idxs_prec));
+    return arma::sp_mat(jac_structure->locations, values, no_dofs, no_dofs, false, true);
+}
+
+arma::vec RootFindingNewton::get_jacobian_vec_prod(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, const arma::vec &vec) const {
+    arma::mat update_mat_b = free_vec_to_mat(vec.subvec(0, _pattern->idx_pairs_free.size()-1));
+    arma::mat prod = update_mat_b * cov_mat_curr;
+    if (_pattern->get_no_non_free() > 0) {
+        arma::mat update_mat_sigma = non_free_vec_to_mat(vec.subvec(_pattern->idx_pairs_free.size(), vec.n_rows-1));
+        prod += prec_mat_curr * update_mat_sigma;
+    }
+    return upper_tri_to_vec(prod);
+}
+
+bool RootFindingNewton::_factorize_jacobian(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, LUFactor &lu_factor) const {
+    arma::mat jac;
+    if (use_sparse_jacobian) {
+        jac = arma::mat(get_jacobian_sparse(prec_mat_curr, cov_mat_curr));
+    } else {
+        jac = get_jacobian(prec_mat_curr, cov_mat_curr);
+    }
+    if (!arma::lu(lu_factor.l_mat, lu_factor.u_mat, lu_factor.p_mat, jac)) {
+        return false;
+    }
+    
+    // Singular if U has a zero on the diagonal
+    return arma::min(arma::abs(lu_factor.u_mat.diag())) > 0.0;
+}
+
+void RootFindingNewton::_solve_lu(const LUFactor &lu_factor, const arma::vec &rhs, arma::vec &update_vec) const {
+    arma::vec tmp = arma::solve(arma::trimatl(lu_factor.l_mat), lu_factor.p_mat * rhs);
+    update_vec = arma::solve(arma::trimatu(lu_factor.u_mat), tmp);
+}
+
+void RootFindingNewton::_solve_lu_broyden(const LUFactor &lu_factor, const arma::mat &s_vecs, const arma::mat &u_vecs, int no_updates, const arma::vec &rhs, arma::vec &update_vec) const {
+    _solve_lu(lu_factor, rhs, update_vec);
+    
+    // H_{j+1} = (I + u_j s_j^T) H_j, oldest first
+    for (auto j=0; j<no_updates; j++) {
+        update_vec += arma::dot(s_vecs.col(j), update_vec) * u_vecs.col(j);
+    }
+}
+
+double RootFindingNewton::_get_forcing_term(int opt_step, double res_norm, double res_norm_prev, double forcing_term_prev) const {
+    if (opt_step == 0) {
+        return ew_forcing_max;
+    }
+    
+    double forcing_term = ew_gamma * pow(res_norm / res_norm_prev, ew_alpha);
+    
+    // Safeguard against the forcing term dropping too fast
+    double forcing_term_safe = ew_gamma * pow(forcing_term_prev, ew_alpha);
+    if (forcing_term_safe > 0.1) {
+        forcing_term = std::max(forcing_term, forcing_term_safe);
+    }
+    
+    return std::min(forcing_term, ew_forcing_max);
+}
+
+double RootFindingNewton::_get_step_size_merit(const arma::mat &prec_mat_curr, const arma::mat &cov_mat_curr, double res_norm, double eta, Workspace &workspace) const {
+    
+    double step_size = 1.0;
+    for (auto i=0; i<max_no_backtracks; i++) {
+        workspace.prec_mat_trial = prec_mat_curr + step_size * workspace.update_mat_b;
+        
+        // Reject steps that leave the PD cone
+        if (workspace.chol_factor.factorize(workspace.prec_mat_trial)) {
+            workspace.cov_mat_trial = cov_mat_curr + step_size * workspace.update_mat_sigma;
+            get_residuals(workspace.prec_mat_trial, workspace.cov_mat_trial, workspace.residuals_trial, workspace.prod_mat);
+            if (arma::norm(workspace.residuals_trial) <= (1.0 - armijo_c * step_size * (1.0 - eta)) * res_norm) {
+                return step_size;
+            }
+        }
+        
+        step_size *= 0.5;
+    }
+    
+    return 0.0;
+}
 
-    arma::vec residuals = get_residuals(prec_mat_curr, cov_mat_curr);
+bool RootFindingNewton::_check_convergence(const Options &options, int opt_step, int no_opt_steps, const arma::vec &residuals) const {
     
     // Max/mean
-    double max_abs_res = arma::max(abs(residuals));
-    double mean_abs_res = arma::mean(abs(residuals));
+    double max_abs_res = 0.0, mean_abs_res = 0.0;
+    for (arma::uword i=0; i<residuals.n_elem; i++) {
+        max_abs_res = std::max(max_abs_res, std::abs(residuals(i)));
+        mean_abs_res += std::abs(residuals(i));
+    }
+    if (residuals.n_elem > 0) {
+        mean_abs_res /= residuals.n_elem;
+    }
     
     if (max_abs_res < conv_max_abs_res) {
         if (options.log_progress) {
@@ -155,15 +348,53 @@ bool RootFindingNewton::_check_convergence(Options options, int opt_step, int no
     return false;
 }
 
-std::pair<arma::mat,arma::mat> RootFindingNewton::solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+std::shared_ptr<SolverBase> RootFindingNewton::_clone_for_pattern(std::shared_ptr<const CompiledPattern> pattern) const {
+    std::shared_ptr<RootFindingNewton> solver = std::make_shared<RootFindingNewton>(*this);
+    solver->_set_pattern(pattern);
+    return solver;
+}
+
+std::pair<arma::mat,arma::mat> RootFindingNewton::_solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
     
     arma::mat prec_mat_curr = prec_mat_init;
     arma::mat cov_mat_curr = cov_mat_true;
-        
+    
+    int no_free = _pattern->get_no_free();
+    int no_dofs = (_dim * (_dim + 1) ) / 2;
+    Workspace workspace(_dim, no_dofs);
+    arma::vec &residuals = workspace.residuals;
+    arma::vec &update_vec = workspace.update_vec;
+    
+    double res_norm_prev = 0.0, forcing_term = 0.0;
+    
+    if (jacobian_refresh != "always" && jacobian_refresh != "shamanskii" && jacobian_refresh != "broyden") {
+        throw std::invalid_argument("Unknown Jacobian refresh policy: " + jacobian_refresh);
+    }
+    if (jacobian_refresh != "always" && jacobian_refresh_interval < 1) {
+        throw std::invalid_argument("Jacobian refresh interval must be at least 1");
+    }
+    
+    // Jacobian reuse; the factor is fresh if it was computed at the current iterate
+    bool reuse_jacobian = !use_jacobian_free && jacobian_refresh != "always";
+    bool use_broyden = (jacobian_refresh == "broyden");
+    LUFactor lu_factor;
+    bool refresh = true, fresh = false;
+    int no_steps_since_refresh = 0, no_broyden_updates = 0;
+    arma::mat broyden_s_vecs, broyden_u_vecs;
+    if (use_broyden) {
+        broyden_s_vecs.zeros(no_dofs, jacobian_refresh_interval);
+        broyden_u_vecs.zeros(no_dofs, jacobian_refresh_interval);
+    }
+    
+    if (globalized && !workspace.chol_factor.factorize(prec_mat_curr)) {
+        throw std::invalid_argument("Initial prec mat is not positive definite!");
+    }
+    
     for (size_t i=0; i<conv_max_no_opt_steps; i++) {
         
         // Check convergence
-        if (_check_convergence(options, i, conv_max_no_opt_steps, prec_mat_curr, cov_mat_curr)) {
+        get_residuals(prec_mat_curr, cov_mat_curr, residuals, workspace.prod_mat);
+        if (_check_convergence(options, i, conv_max_no_opt_steps, residuals)) {
             return std::make_pair(cov_mat_curr,prec_mat_curr);
         }
         
@@ -173,19 +404,127 @@ std::pair<arma::mat,arma::mat> RootFindingNewton::solve(const arma::mat &cov_mat
         // Write if needed
         _write_progress_if_needed(options, i, prec_mat_curr, cov_mat_curr);
         
-        // Update
-        arma::vec residuals = get_residuals(prec_mat_curr, cov_mat_curr);
-        arma::mat jac = get_jacobian(prec_mat_curr, cov_mat_curr);
-        arma::vec update_vec = arma::solve(jac, - residuals);
-
-        // Update
-        arma::vec update_vec_b = update_vec.subvec(0, _idx_pairs_free.size()-1);
-        arma::vec update_vec_sigma = update_vec.subvec(_idx_pairs_free.size(), update_vec.n_rows-1);
-        arma::mat update_mat_b = free_vec_to_mat(update_vec_b);
-        arma::mat update_mat_sigma = non_free_vec_to_mat(update_vec_sigma);
+        // Update; the rhs is the negated residuals, formed in place
+        residuals *= -1.0;
+        bool solved;
+        if (reuse_jacobian) {
+            double res_norm = arma::norm(residuals);
+            
+            // Refresh after the max no reuses, or if the residuals contract too slowly
+            if (no_steps_since_refresh >= jacobian_refresh_interval || (no_steps_since_refresh > 0 && res_norm > max_contraction_ratio * res_norm_prev)) {
+                refresh = true;
+            }
+            res_norm_prev = res_norm;
+            
+            // Good Broyden update from the last step, with y = F_k - F_{k-1} and the residuals holding - F_k
+            if (!refresh && use_broyden) {
+                arma::vec y_vec = - residuals - workspace.residuals_prev;
+                arma::vec h_y_vec;
+                _solve_lu_broyden(lu_factor, broyden_s_vecs, broyden_u_vecs, no_broyden_updates, y_vec, h_y_vec);
+                double denom = arma::dot(workspace.step_vec, h_y_vec);
+                if (std::abs(denom) > 1e-12 * arma::norm(workspace.step_vec) * arma::norm(h_y_vec)) {
+                    broyden_s_vecs.col(no_broyden_updates) = workspace.step_vec;
+                    broyden_u_vecs.col(no_broyden_updates) = (workspace.step_vec - h_y_vec) / denom;
+                    no_broyden_updates++;
+                } else {
+                    refresh = true;
+                }
+            }
+            
+            solved = true;
+            fresh = refresh;
+            if (refresh) {
+                if (stats) {
+                    stats->no_jacobian_factorizations++;
+                }
+                solved = _factorize_jacobian(prec_mat_curr, cov_mat_curr, lu_factor);
+                no_steps_since_refresh = 0;
+                no_broyden_updates = 0;
+                refresh = false;
+            }
+            if (solved) {
+                _solve_lu_broyden(lu_factor, broyden_s_vecs, broyden_u_vecs, no_broyden_updates, residuals, update_vec);
+                solved = update_vec.is_finite();
+            }
+            no_steps_since_refresh++;
+            workspace.residuals_prev = - residuals;
+        } else if (use_jacobian_free) {
+            double res_norm = arma::norm(residuals);
+            forcing_term = _get_forcing_term(i, res_norm, res_norm_prev, forcing_term);
+            res_norm_prev = res_norm;
+            
+            MatVecProd jac_vec_prod = [&](const arma::vec &vec) {
+                return get_jacobian_vec_prod(prec_mat_curr, cov_mat_curr, vec);
+            };
+            update_vec = solve_gmres(jac_vec_prod, residuals, forcing_term * res_norm, gmres_restart, gmres_max_no_steps);
+            solved = update_vec.is_finite();
+        } else if (use_sparse_jacobian) {
+            if (stats) {
+                stats->no_jacobian_factorizations++;
+            }
+            arma::sp_mat jac = get_jacobian_sparse(prec_mat_curr, cov_mat_curr);
+            solved = arma::spsolve(update_vec, jac, residuals, sparse_solver.c_str());
+        } else {
+            if (stats) {
+                stats->no_jacobian_factorizations++;
+            }
+            arma::mat jac = get_jacobian(prec_mat_curr, cov_mat_curr);
+            solved = arma::solve(update_vec, jac, residuals);
+        }
+        if (!solved) {
+            if (options.log_progress) {
+                std::string header = _get_log_header(options, i, conv_max_no_opt_steps);
+                spdlog::info(header + "Stopping: Jacobian is singular");
+            }
+            return std::make_pair(cov_mat_curr,prec_mat_curr);
+        }
+
+        // Update; the two parts of the update vec are viewed without copying
+        const arma::vec update_vec_b(update_vec.memptr(), no_free, false, true);
+        free_vec_to_mat(update_vec_b, workspace.update_mat_b);
+        if (no_dofs > no_free) {
+            const arma::vec update_vec_sigma(update_vec.memptr() + no_free, no_dofs - no_free, false, true);
+            non_free_vec_to_mat(update_vec_sigma, workspace.update_mat_sigma);
+        }
         
-        prec_mat_curr += update_mat_b;
-        cov_mat_curr += update_mat_sigma;
+        // Damp the step if globalized
+        double step_size = 1.0;
+        if (globalized) {
+            double eta = use_jacobian_free ? forcing_term : 0.0;
+            step_size = _get_step_size_merit(prec_mat_curr, cov_mat_curr, arma::norm(residuals), eta, workspace);
+            
+            // A reused Jacobian may give a poor direction: retry with a fresh one
+            if (step_size == 0.0 && reuse_jacobian && !fresh) {
+                refresh = true;
+                continue;
+            }
+            
+            if (step_size == 0.0) {
+                if (options.log_progress) {
+                    std::string header = _get_log_header(options, i, conv_max_no_opt_steps);
+                    spdlog::info(header + "Stopping: line search failed to find an acceptable step");
+                }
+                return std::make_pair(cov_mat_curr,prec_mat_curr);
+            }
+            
+            // The line search leaves the accepted step in the trial buffers
+            std::swap(prec_mat_curr, workspace.prec_mat_trial);
+            std::swap(cov_mat_curr, workspace.cov_mat_trial);
+        } else {
+            prec_mat_curr += workspace.update_mat_b;
+            if (no_dofs > no_free) {
+                cov_mat_curr += workspace.update_mat_sigma;
+            }
+        }
+        
+        if (stats) {
+            stats->no_opt_steps++;
+        }
+        
+        // Step taken, for the next Broyden update
+        if (reuse_jacobian && use_broyden) {
+            workspace.step_vec = step_size * update_vec;
+        }
     }
     
     if (options.log_progress) {
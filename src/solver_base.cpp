@@ -29,30 +29,23 @@ SOFTWARE.
 
 #include "../include/ggm_inversion_bits/solver_base.hpp"
 #include "../include/ggm_inversion_bits/helpers.hpp"
+#include "../include/ggm_inversion_bits/thread_pool.hpp"
+#include "../include/ggm_inversion_bits/chol_factor.hpp"
 
 #include <spdlog/spdlog.h>
+#include <algorithm>
 
 namespace ginv {
 
-SolverBase::SolverBase(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free) {
-    _idx_pairs_free = idx_pairs_free;
-    _dim = dim;
-    
-    // Check
-    for (auto pr: _idx_pairs_free) {
-        assert(pr.first < _dim);
-        assert(pr.second < _dim);
-    }
-    
-    // Non-free idxs
-    for (auto i=0; i<_dim; i++) {
-        for (auto j=i; j<_dim; j++) {
-            std::pair<int,int> pr = std::make_pair(i,j);
-            if (!_check_pair_exists(_idx_pairs_free, pr)) {
-                _idx_pairs_non_free.push_back(pr);
-            }
-        }
-    }
+SolverBase::SolverBase(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free) : SolverBase(compile_pattern(dim, idx_pairs_free)) {
+}
+
+SolverBase::SolverBase(std::shared_ptr<const CompiledPattern> pattern) {
+    _pattern = pattern;
+    _dim = pattern->dim;
+    _decomposition = pattern->get_derived<PatternDecomposition>([&] {
+        return std::make_shared<const PatternDecomposition>(*pattern);
+    });
 }
 
 SolverBase::SolverBase(const SolverBase& other) {
@@ -84,14 +77,101 @@ void SolverBase::_clean_up() {
 };
 
 void SolverBase::_copy(const SolverBase& other) {
-    _idx_pairs_free = other._idx_pairs_free;
+    _pattern = other._pattern;
     _dim = other._dim;
+    _decomposition = other._decomposition;
+    log_header = other.log_header;
+    options = other.options;
+    decompose_components = other.decompose_components;
+    decompose_separators = other.decompose_separators;
+    no_threads_components = other.no_threads_components;
+    warm_start_cache = other.warm_start_cache;
 };
 void SolverBase::_move(SolverBase& other) {
-    _idx_pairs_free = other._idx_pairs_free;
+    _pattern = other._pattern;
     _dim = other._dim;
+    _decomposition = std::move(other._decomposition);
+    log_header = other.log_header;
+    options = other.options;
+    decompose_components = other.decompose_components;
+    decompose_separators = other.decompose_separators;
+    no_threads_components = other.no_threads_components;
+    warm_start_cache = other.warm_start_cache;
 };
 
+void SolverBase::_set_pattern(std::shared_ptr<const CompiledPattern> pattern) {
+    _pattern = pattern;
+    _dim = pattern->dim;
+    _decomposition = pattern->get_derived<PatternDecomposition>([&] {
+        return std::make_shared<const PatternDecomposition>(*pattern);
+    });
+}
+
+PatternDecomposition::PatternDecomposition(const CompiledPattern &pattern) {
+    int dim = pattern.dim;
+    
+    // Label by DFS over the adjacency
+    std::vector<int> labels(dim, -1);
+    std::vector<std::vector<arma::uword>> vertex_sets;
+    std::vector<int> stack;
+    for (auto i=0; i<dim; i++) {
+        if (labels[i] >= 0) {
+            continue;
+        }
+        int label = vertex_sets.size();
+        vertex_sets.push_back({});
+        labels[i] = label;
+        stack.push_back(i);
+        while (!stack.empty()) {
+            int v = stack.back();
+            stack.pop_back();
+            vertex_sets.back().push_back(v);
+            for (auto s=pattern.adj_ptr[v]; s<pattern.adj_ptr[v+1]; s++) {
+                int u = pattern.adj_idx[s];
+                if (labels[u] < 0) {
+                    labels[u] = label;
+                    stack.push_back(u);
+                }
+            }
+        }
+    }
+    
+    // Components are decomposed further by their own solvers
+    if (vertex_sets.size() > 1) {
+        for (auto &vertex_set: vertex_sets) {
+            std::sort(vertex_set.begin(), vertex_set.end());
+            components.push_back(arma::uvec(vertex_set));
+            component_patterns.push_back(compile_sub_pattern(pattern, components.back()));
+        }
+    }
+}
+
+PatternAtoms::PatternAtoms(const CompiledPattern &pattern) {
+    
+    // Gluing needs the full target on the separators
+    for (auto i=0; i<pattern.dim; i++) {
+        if (!pattern.check_free(i, i)) {
+            return;
+        }
+    }
+    
+    AtomDecomposition atoms_found = get_atoms(pattern);
+    if (atoms_found.atoms.size() <= 1) {
+        return;
+    }
+    
+    atom_decomposition = atoms_found;
+    for (auto const &atom: atom_decomposition.atoms) {
+        bool is_complete = true;
+        for (arma::uword a=0; a<atom.n_elem && is_complete; a++) {
+            for (arma::uword b=a+1; b<atom.n_elem && is_complete; b++) {
+                is_complete = pattern.check_free(atom(a), atom(b));
+            }
+        }
+        atom_patterns.push_back(is_complete ? nullptr : compile_sub_pattern(pattern, atom));
+    }
+}
+
 std::string SolverBase::_get_log_header(const Options &options, int opt_step, int max_no_opt_steps) const {
     return _get_log_header(log_header, opt_step, max_no_opt_steps);
 }
@@ -116,24 +196,12 @@ void SolverBase::_log_mat_info(const arma::mat &mat, std::string header) const {
     }
 }
 
-bool SolverBase::_check_pair_exists(const std::vector<std::pair<int,int>> &pairs, std::pair<int,int> pr_search) const {
-                
-    auto it = std::find(pairs.begin(), pairs.end(), pr_search);
-    if (it != pairs.end()) {
-        return true;
-    }
-    
-    std::pair<int,int> pr_reverse = std::make_pair(pr_search.second, pr_search.first);
-    auto it2 = std::find(pairs.begin(), pairs.end(), pr_reverse);
-    if (it2 != pairs.end()) {
-        return true;
-    } else {
-        return false;
-    }
+std::vector<std::pair<int,int>> SolverBase::get_idx_pairs_free() const {
+    return _pattern->idx_pairs_free;
 }
 
-std::vector<std::pair<int,int>> SolverBase::get_idx_pairs_free() const {
-    return _idx_pairs_free;
+std::shared_ptr<const CompiledPattern> SolverBase::get_pattern() const {
+    return _pattern;
 }
 
 int SolverBase::get_dim() const {
@@ -141,71 +209,338 @@ int SolverBase::get_dim() const {
 }
 
 arma::mat SolverBase::free_vec_to_mat(const arma::vec &vec) const {
+    arma::mat mat;
+    free_vec_to_mat(vec, mat);
+    return mat;
+}
+
+arma::mat SolverBase::non_free_vec_to_mat(const arma::vec &vec) const {
+    arma::mat mat;
+    non_free_vec_to_mat(vec, mat);
+    return mat;
+}
+
+arma::vec SolverBase::free_mat_to_vec(const arma::mat &mat) const {
+    arma::vec vec;
+    free_mat_to_vec(mat, vec);
+    return vec;
+}
+
+arma::vec SolverBase::non_free_mat_to_vec(const arma::mat &mat) const {
+    arma::vec vec;
+    non_free_mat_to_vec(mat, vec);
+    return vec;
+}
+
+arma::mat SolverBase::zero_free_elements(const arma::mat &mat) const {
+    arma::mat out;
+    zero_free_elements(mat, out);
+    return out;
+}
+
+arma::mat SolverBase::zero_non_free_elements(const arma::mat &mat) const {
+    arma::mat out;
+    zero_non_free_elements(mat, out);
+    return out;
+}
+
+void SolverBase::free_vec_to_mat(const arma::vec &vec, arma::mat &mat) const {
     
-    arma::mat mat = arma::zeros(_dim,_dim);
-    for (size_t i=0; i<_idx_pairs_free.size(); i++) {
-        auto pr = _idx_pairs_free.at(i);
-        mat(pr.first, pr.second) = vec(i);
-        mat(pr.second, pr.first) = vec(i);
+    mat.zeros(_dim,_dim);
+    double *mat_mem = mat.memptr();
+    const double *vec_mem = vec.memptr();
+    const arma::uword *offsets = _pattern->free_offsets.data();
+    const arma::uword *offsets_trans = _pattern->free_offsets_trans.data();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        mat_mem[offsets[s]] = vec_mem[s];
+        mat_mem[offsets_trans[s]] = vec_mem[s];
     }
+}
+
+void SolverBase::non_free_vec_to_mat(const arma::vec &vec, arma::mat &mat) const {
+    std::shared_ptr<const NonFreeSlots> non_free_slots = _pattern->get_non_free_slots();
     
-    return mat;
+    mat.zeros(_dim,_dim);
+    double *mat_mem = mat.memptr();
+    const double *vec_mem = vec.memptr();
+    const arma::uword *offsets = non_free_slots->non_free_offsets.data();
+    const arma::uword *offsets_trans = non_free_slots->non_free_offsets_trans.data();
+    for (size_t s=0; s<non_free_slots->non_free_offsets.size(); s++) {
+        mat_mem[offsets[s]] = vec_mem[s];
+        mat_mem[offsets_trans[s]] = vec_mem[s];
+    }
 }
 
-arma::mat SolverBase::non_free_vec_to_mat(const arma::vec &vec) const {
+void SolverBase::free_mat_to_vec(const arma::mat &mat, arma::vec &vec) const {
     
-    arma::mat mat = arma::zeros(_dim,_dim);
-    for (size_t i=0; i<_idx_pairs_non_free.size(); i++) {
-        auto pr = _idx_pairs_non_free.at(i);
-        mat(pr.first, pr.second) = vec(i);
-        mat(pr.second, pr.first) = vec(i);
+    vec.set_size(_pattern->free_offsets.size());
+    double *vec_mem = vec.memptr();
+    const double *mat_mem = mat.memptr();
+    const arma::uword *offsets = _pattern->free_offsets.data();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        vec_mem[s] = mat_mem[offsets[s]];
     }
+}
+
+void SolverBase::non_free_mat_to_vec(const arma::mat &mat, arma::vec &vec) const {
+    std::shared_ptr<const NonFreeSlots> non_free_slots = _pattern->get_non_free_slots();
     
-    return mat;
+    vec.set_size(non_free_slots->non_free_offsets.size());
+    double *vec_mem = vec.memptr();
+    const double *mat_mem = mat.memptr();
+    const arma::uword *offsets = non_free_slots->non_free_offsets.data();
+    for (size_t s=0; s<non_free_slots->non_free_offsets.size(); s++) {
+        vec_mem[s] = mat_mem[offsets[s]];
+    }
 }
 
-arma::vec SolverBase::free_mat_to_vec(const arma::mat &mat) const {
+void SolverBase::zero_free_elements(const arma::mat &mat, arma::mat &out) const {
     
-    arma::vec vec(_idx_pairs_free.size());
-    for (size_t i=0; i<_idx_pairs_free.size(); i++) {
-        auto pr = _idx_pairs_free.at(i);
-        vec(i) = mat(pr.first, pr.second);
+    out = mat;
+    double *out_mem = out.memptr();
+    const arma::uword *offsets = _pattern->free_offsets.data();
+    const arma::uword *offsets_trans = _pattern->free_offsets_trans.data();
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        out_mem[offsets[s]] = 0;
+        out_mem[offsets_trans[s]] = 0;
     }
+}
+
+void SolverBase::zero_non_free_elements(const arma::mat &mat, arma::mat &out) const {
+    std::shared_ptr<const NonFreeSlots> non_free_slots = _pattern->get_non_free_slots();
     
-    return vec;
+    out = mat;
+    double *out_mem = out.memptr();
+    const arma::uword *offsets = non_free_slots->non_free_offsets.data();
+    const arma::uword *offsets_trans = non_free_slots->non_free_offsets_trans.data();
+    for (size_t s=0; s<non_free_slots->non_free_offsets.size(); s++) {
+        out_mem[offsets[s]] = 0;
+        out_mem[offsets_trans[s]] = 0;
+    }
 }
 
-arma::vec SolverBase::non_free_mat_to_vec(const arma::mat &mat) const {
+arma::sp_mat SolverBase::free_vec_to_sp_mat(const arma::vec &vec) const {
     
-    arma::vec vec(_idx_pairs_non_free.size());
-    for (size_t i=0; i<_idx_pairs_non_free.size(); i++) {
-        auto pr = _idx_pairs_non_free.at(i);
-        vec(i) = mat(pr.first, pr.second);
+    // Both (i,j) and (j,i) for off-diagonal slots
+    size_t no_free = _pattern->free_offsets.size();
+    size_t no_off_diag = 0;
+    for (size_t s=0; s<no_free; s++) {
+        if (_pattern->free_rows[s] != _pattern->free_cols[s]) {
+            no_off_diag++;
+        }
     }
     
+    arma::umat locations(2, no_free + no_off_diag);
+    arma::vec values(no_free + no_off_diag);
+    size_t ctr = 0;
+    for (size_t s=0; s<no_free; s++) {
+        locations(0,ctr) = _pattern->free_rows[s];
+        locations(1,ctr) = _pattern->free_cols[s];
+        values(ctr++) = vec(s);
+        if (_pattern->free_rows[s] != _pattern->free_cols[s]) {
+            locations(0,ctr) = _pattern->free_cols[s];
+            locations(1,ctr) = _pattern->free_rows[s];
+            values(ctr++) = vec(s);
+        }
+    }
+    
+    // Zeros at free elements are kept, so the structure is the pattern
+    return arma::sp_mat(locations, values, _dim, _dim, true, false);
+}
+
+arma::vec SolverBase::free_sp_mat_to_vec(const arma::sp_mat &mat) const {
+    
+    arma::vec vec(_pattern->free_offsets.size());
+    for (size_t s=0; s<_pattern->free_offsets.size(); s++) {
+        vec(s) = mat(_pattern->free_rows[s], _pattern->free_cols[s]);
+    }
     return vec;
 }
 
-arma::mat SolverBase::zero_free_elements(const arma::mat &mat) const {
-    arma::mat out = mat;
-    for (auto pr: _idx_pairs_free) {
-        out(pr.first,pr.second) = 0;
-        out(pr.second,pr.first) = 0;
+bool SolverBase::_supports_concurrent_solves() const {
+    return true;
+}
+
+std::pair<arma::mat,arma::mat> SolverBase::solve(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    if (!warm_start_cache) {
+        return _solve_decomposed(cov_mat_true, prec_mat_init);
     }
     
-    return out;
+    arma::vec cov_vec_true = free_mat_to_vec(cov_mat_true);
+    arma::mat prec_mat_cached;
+    double dist;
+    std::pair<arma::mat,arma::mat> pr;
+    CholFactor chol_factor;
+    if (warm_start_cache->lookup(*_pattern, cov_vec_true, prec_mat_cached, dist) && chol_factor.factorize(prec_mat_cached)) {
+        if (options.log_progress) {
+            spdlog::info(log_header + "Warm start from a cached solution at distance {:e}", dist);
+        }
+        pr = _solve_decomposed(cov_mat_true, prec_mat_cached);
+    } else {
+        if (options.log_progress && prec_mat_cached.n_elem > 0) {
+            spdlog::info(log_header + "Cached solution at distance {:e} is not positive definite; using the initial prec mat", dist);
+        }
+        pr = _solve_decomposed(cov_mat_true, prec_mat_init);
+    }
+    
+    // Failed solves are not cached, so they cannot seed later ones
+    if (chol_factor.factorize(pr.second)) {
+        warm_start_cache->insert(_pattern, cov_vec_true, pr.second);
+    } else if (options.log_progress) {
+        spdlog::info(log_header + "Solution is not positive definite; not cached");
+    }
+    return pr;
 }
 
-arma::mat SolverBase::zero_non_free_elements(const arma::mat &mat) const {
-    arma::mat out = mat;
-    for (auto pr: _idx_pairs_non_free) {
-        out(pr.first,pr.second) = 0;
-        out(pr.second,pr.first) = 0;
+std::pair<arma::mat,arma::mat> SolverBase::_solve_decomposed(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    if (decompose_components && _decomposition->components.size() > 1) {
+        return _solve_components(cov_mat_true, prec_mat_init);
+    }
+    if (decompose_separators && _decomposition->components.empty()) {
+        std::shared_ptr<const PatternAtoms> pattern_atoms = _pattern->get_derived<PatternAtoms>([&] {
+            return std::make_shared<const PatternAtoms>(*_pattern);
+        });
+        if (pattern_atoms->atom_decomposition.atoms.size() > 1) {
+            return _solve_atoms(*pattern_atoms, cov_mat_true, prec_mat_init);
+        }
     }
+    return _solve(cov_mat_true, prec_mat_init);
+}
+
+std::pair<arma::mat,arma::mat> SolverBase::_solve_components(const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
     
-    return out;
+    arma::mat cov_mat_soln = arma::zeros(_dim,_dim);
+    arma::mat prec_mat_soln = arma::zeros(_dim,_dim);
+    
+    const std::vector<arma::uvec> &components = _decomposition->components;
+    const std::vector<std::shared_ptr<const CompiledPattern>> &component_patterns = _decomposition->component_patterns;
+    
+    int no_threads = _supports_concurrent_solves() ? no_threads_components : 1;
+    parallel_for(components.size(), no_threads, [&](int c) {
+        const arma::uvec &component = components[c];
+        
+        arma::mat cov_mat_block, prec_mat_block;
+        if (component.n_elem == 1 && component_patterns[c]->check_free(0, 0)) {
+            // Single free diagonal element
+            double cov_ii = cov_mat_true(component(0), component(0));
+            if (cov_ii <= 0) {
+                throw std::invalid_argument("Target cov mat is not positive definite!");
+            }
+            cov_mat_block = cov_ii * arma::ones(1,1);
+            prec_mat_block = (1.0 / cov_ii) * arma::ones(1,1);
+        } else {
+            std::shared_ptr<SolverBase> solver = _clone_for_pattern(component_patterns[c]);
+            solver->log_header = log_header + format_str("[Block %d] ", c);
+            solver->warm_start_cache = nullptr;
+            if (options.write_progress) {
+                solver->options.write_dir = options.write_dir + format_str("block_%d/", c);
+                ensure_dir_exists(solver->options.write_dir);
+            }
+            
+            arma::mat prec_mat_init_block;
+            if (prec_mat_init.n_elem > 0) {
+                prec_mat_init_block = prec_mat_init.submat(component, component);
+            }
+            
+            // Components may decompose further into atoms
+            auto pr = solver->solve(cov_mat_true.submat(component, component), prec_mat_init_block);
+            cov_mat_block = pr.first;
+            prec_mat_block = pr.second;
+        }
+        
+        // Blocks are disjoint, so no locking is needed
+        cov_mat_soln.submat(component, component) = cov_mat_block;
+        prec_mat_soln.submat(component, component) = prec_mat_block;
+    });
+    
+    return std::make_pair(cov_mat_soln, prec_mat_soln);
 }
 
-};
+std::pair<arma::mat,arma::mat> SolverBase::_solve_atoms(const PatternAtoms &pattern_atoms, const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) const {
+    
+    const std::vector<arma::uvec> &atoms = pattern_atoms.atom_decomposition.atoms;
+    const std::vector<std::shared_ptr<const CompiledPattern>> &atom_patterns = pattern_atoms.atom_patterns;
+    std::vector<arma::mat> prec_mats_atoms(atoms.size());
+    
+    int no_threads = _supports_concurrent_solves() ? no_threads_components : 1;
+    parallel_for(atoms.size(), no_threads, [&](int a) {
+        const arma::uvec &atom = atoms[a];
+        
+        if (!atom_patterns[a]) {
+            // Complete atom
+            CholFactor chol_factor;
+            if (!chol_factor.factorize(cov_mat_true.submat(atom, atom))) {
+                throw std::invalid_argument("Target cov mat is not positive definite on an atom!");
+            }
+            prec_mats_atoms[a] = chol_factor.get_inv();
+        } else {
+            std::shared_ptr<SolverBase> solver = _clone_for_pattern(atom_patterns[a]);
+            solver->log_header = log_header + format_str("[Atom %d] ", a);
+            solver->warm_start_cache = nullptr;
+            if (options.write_progress) {
+                solver->options.write_dir = options.write_dir + format_str("atom_%d/", a);
+                ensure_dir_exists(solver->options.write_dir);
+            }
+            
+            arma::mat prec_mat_init_atom;
+            if (prec_mat_init.n_elem > 0) {
+                prec_mat_init_atom = prec_mat_init.submat(atom, atom);
+            }
+            
+            // Atoms have no clique separators, so solve directly
+            prec_mats_atoms[a] = solver->_solve(cov_mat_true.submat(atom, atom), prec_mat_init_atom).second;
+        }
+    });
+    
+    // Glue
+    arma::mat prec_mat_soln = arma::zeros(_dim,_dim);
+    for (size_t a=0; a<atoms.size(); a++) {
+        prec_mat_soln.submat(atoms[a], atoms[a]) += prec_mats_atoms[a];
+    }
+    
+    CholFactor chol_factor;
+    for (auto const &separator: pattern_atoms.atom_decomposition.separators) {
+        if (separator.n_elem == 0) {
+            continue;
+        }
+        if (!chol_factor.factorize(cov_mat_true.submat(separator, separator))) {
+            throw std::invalid_argument("Target cov mat is not positive definite on a separator!");
+        }
+        prec_mat_soln.submat(separator, separator) -= chol_factor.get_inv();
+    }
+    
+    // Not PD only if an atom was not solved
+    arma::mat cov_mat_soln;
+    if (chol_factor.factorize(prec_mat_soln)) {
+        cov_mat_soln = chol_factor.get_inv();
+    } else {
+        if (options.log_progress) {
+            spdlog::warn(log_header + "Glued prec mat is not positive definite");
+        }
+        cov_mat_soln = arma::inv(prec_mat_soln);
+    }
+    
+    return std::make_pair(cov_mat_soln, prec_mat_soln);
+}
 
+std::vector<std::pair<arma::mat,arma::mat>> SolverBase::solve_batch(const std::vector<arma::mat> &cov_mats_true, const arma::mat &prec_mat_init, int no_threads) const {
+    std::vector<arma::mat> prec_mats_init(cov_mats_true.size(), prec_mat_init);
+    return solve_batch(cov_mats_true, prec_mats_init, no_threads);
+}
+
+std::vector<std::pair<arma::mat,arma::mat>> SolverBase::solve_batch(const std::vector<arma::mat> &cov_mats_true, const std::vector<arma::mat> &prec_mats_init, int no_threads) const {
+    assert(cov_mats_true.size() == prec_mats_init.size());
+    
+    if (!_supports_concurrent_solves()) {
+        no_threads = 1;
+    }
+    
+    std::vector<std::pair<arma::mat,arma::mat>> solns(cov_mats_true.size());
+    parallel_for(cov_mats_true.size(), no_threads, [&](int i) {
+        solns[i] = solve(cov_mats_true[i], prec_mats_init[i]);
+    });
+    
+    return solns;
+}
 
+};
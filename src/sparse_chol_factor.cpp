@@ -0,0 +1,339 @@
+//
+/*
+File: sparse_chol_factor.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/sparse_chol_factor.hpp"
+#include "../include/ggm_inversion_bits/graph.hpp"
+
+#include <algorithm>
+
+namespace ginv {
+
+SparseCholSymbolic::SparseCholSymbolic(const CompiledPattern &pattern) {
+    dim = pattern.dim;
+    
+    // Ordering
+    perm = get_min_degree_order(pattern);
+    perm_inv.assign(dim, 0);
+    for (auto k=0; k<dim; k++) {
+        perm_inv[perm[k]] = k;
+    }
+    
+    // Upper triangle of the permuted pattern, with the diagonal
+    col_ptrs_c.assign(dim + 1, 0);
+    row_idxs_c.clear();
+    for (auto k=0; k<dim; k++) {
+        int v = perm[k];
+        row_idxs_c.push_back(k);
+        for (auto s=pattern.adj_ptr[v]; s<pattern.adj_ptr[v+1]; s++) {
+            int i = perm_inv[pattern.adj_idx[s]];
+            if (i < k) {
+                row_idxs_c.push_back(i);
+            }
+        }
+        col_ptrs_c[k+1] = row_idxs_c.size();
+    }
+    
+    // Elimination tree, with path compression through ancestors
+    parent.assign(dim, -1);
+    std::vector<int> ancestors(dim, -1);
+    for (auto k=0; k<dim; k++) {
+        for (auto p=col_ptrs_c[k]; p<col_ptrs_c[k+1]; p++) {
+            int i = row_idxs_c[p];
+            while (i != -1 && i < k) {
+                int i_next = ancestors[i];
+                ancestors[i] = k;
+                if (i_next == -1) {
+                    parent[i] = k;
+                }
+                i = i_next;
+            }
+        }
+    }
+    
+    // Col counts of L from the row patterns
+    std::vector<int> stack(dim, 0), marks(dim, -1), next(dim, 0);
+    col_counts.assign(dim, 1);
+    for (auto k=0; k<dim; k++) {
+        for (auto p=ereach(k, stack, marks, next); p<dim; p++) {
+            col_counts[stack[p]]++;
+        }
+    }
+    col_ptrs_l.assign(dim + 1, 0);
+    for (auto k=0; k<dim; k++) {
+        col_ptrs_l[k+1] = col_ptrs_l[k] + col_counts[k];
+    }
+    
+    // Row indices of L; rows are visited in increasing order, so each col comes out sorted with the diagonal first
+    row_idxs_l.assign(col_ptrs_l[dim], 0);
+    std::vector<int> col_fill(col_ptrs_l.begin(), col_ptrs_l.end() - 1);
+    std::fill(marks.begin(), marks.end(), -1);
+    for (auto k=0; k<dim; k++) {
+        for (auto p=ereach(k, stack, marks, next); p<dim; p++) {
+            row_idxs_l[col_fill[stack[p]]++] = k;
+        }
+        row_idxs_l[col_fill[k]++] = k;
+    }
+    
+    // Fundamental supernodes: j+1 continues the supernode of j if j is its only child and the patterns nest
+    std::vector<int> no_children(dim, 0);
+    for (auto j=0; j<dim; j++) {
+        if (parent[j] != -1) {
+            no_children[parent[j]]++;
+        }
+    }
+    super_ptrs.clear();
+    super_ptrs.push_back(0);
+    for (auto j=1; j<dim; j++) {
+        if (!(parent[j-1] == j && no_children[j] == 1 && col_counts[j-1] == col_counts[j] + 1)) {
+            super_ptrs.push_back(j);
+        }
+    }
+    if (dim > 0) {
+        super_ptrs.push_back(dim);
+    }
+}
+
+int SparseCholSymbolic::get_no_supernodes() const {
+    return super_ptrs.size() - 1;
+}
+
+int SparseCholSymbolic::ereach(int k, std::vector<int> &stack, std::vector<int> &marks, std::vector<int> &next) const {
+    
+    // Walk up the etree from each nonzero of col k of the upper triangle, stopping at marked nodes
+    int top = dim;
+    marks[k] = k;
+    for (auto p=col_ptrs_c[k]; p<col_ptrs_c[k+1]; p++) {
+        int i = row_idxs_c[p];
+        if (i >= k) {
+            continue;
+        }
+        int len = 0;
+        for (; marks[i] != k; i=parent[i]) {
+            next[len++] = i;
+            marks[i] = k;
+        }
+        while (len > 0) {
+            stack[--top] = next[--len];
+        }
+    }
+    return top;
+}
+
+SparseCholFactor::SparseCholFactor() {
+    _is_pd = false;
+}
+
+void SparseCholFactor::analyze(const CompiledPattern &pattern) {
+    analyze(pattern.get_sparse_chol_symbolic());
+}
+
+void SparseCholFactor::analyze(std::shared_ptr<const SparseCholSymbolic> symbolic) {
+    _symbolic = symbolic;
+    int dim = _symbolic->dim;
+    
+    _stack.assign(dim, 0);
+    _next.assign(dim, 0);
+    _marks.assign(dim, -1);
+    _col_fill.assign(dim, 0);
+    _work.assign(dim, 0.0);
+    _vals_l.assign(_symbolic->col_ptrs_l[dim], 0.0);
+    
+    _is_pd = false;
+}
+
+std::shared_ptr<const SparseCholSymbolic> SparseCholFactor::get_symbolic() const {
+    return _symbolic;
+}
+
+bool SparseCholFactor::factorize(const arma::sp_mat &mat) {
+    assert(_symbolic);
+    const SparseCholSymbolic &sym = *_symbolic;
+    int dim = sym.dim;
+    assert((int)mat.n_rows == dim && (int)mat.n_cols == dim);
+    
+    // Next free slot in each col of L
+    std::copy(sym.col_ptrs_l.begin(), sym.col_ptrs_l.end() - 1, _col_fill.begin());
+    std::fill(_marks.begin(), _marks.end(), -1);
+    
+    _is_pd = true;
+    for (auto k=0; k<dim && _is_pd; k++) {
+        
+        // Row pattern first, since ereach uses _next as scratch
+        int top = sym.ereach(k, _stack, _marks, _next);
+        
+        // Scatter the upper part of col k of the permuted mat
+        int col = sym.perm[k];
+        for (arma::sp_mat::const_col_iterator it=mat.begin_col(col); it!=mat.end_col(col); ++it) {
+            int i = sym.perm_inv[it.row()];
+            if (i <= k) {
+                _work[i] = *it;
+            }
+        }
+        double diag = _work[k];
+        _work[k] = 0.0;
+        
+        // Sparse triangular solve for row k of L
+        for (auto p=top; p<dim; p++) {
+            int i = _stack[p];
+            double l_ki = _work[i] / _vals_l[sym.col_ptrs_l[i]];
+            _work[i] = 0.0;
+            for (auto q=sym.col_ptrs_l[i]+1; q<_col_fill[i]; q++) {
+                _work[sym.row_idxs_l[q]] -= _vals_l[q] * l_ki;
+            }
+            diag -= l_ki * l_ki;
+            _vals_l[_col_fill[i]++] = l_ki;
+        }
+        
+        // Entries outside the pattern were scattered but not consumed
+        for (arma::sp_mat::const_col_iterator it=mat.begin_col(col); it!=mat.end_col(col); ++it) {
+            int i = sym.perm_inv[it.row()];
+            if (i <= k) {
+                _work[i] = 0.0;
+            }
+        }
+        
+        if (diag <= 0.0) {
+            _is_pd = false;
+            break;
+        }
+        _vals_l[_col_fill[k]++] = sqrt(diag);
+    }
+    
+    return _is_pd;
+}
+
+bool SparseCholFactor::is_pd() const {
+    return _is_pd;
+}
+
+int SparseCholFactor::get_no_nonzeros() const {
+    return _symbolic ? _symbolic->col_ptrs_l[_symbolic->dim] : 0;
+}
+
+double SparseCholFactor::get_log_det() const {
+    assert(_is_pd);
+    
+    double log_det = 0.0;
+    for (auto k=0; k<_symbolic->dim; k++) {
+        log_det += 2.0 * log(_vals_l[_symbolic->col_ptrs_l[k]]);
+    }
+    return log_det;
+}
+
+void SparseCholFactor::solve_in_place(arma::vec &vec) const {
+    assert(_is_pd);
+    const SparseCholSymbolic &sym = *_symbolic;
+    int dim = sym.dim;
+    
+    // x = P b
+    arma::vec x(dim);
+    for (auto k=0; k<dim; k++) {
+        x(k) = vec(sym.perm[k]);
+    }
+    
+    // L y = x
+    for (auto j=0; j<dim; j++) {
+        x(j) /= _vals_l[sym.col_ptrs_l[j]];
+        for (auto p=sym.col_ptrs_l[j]+1; p<sym.col_ptrs_l[j+1]; p++) {
+            x(sym.row_idxs_l[p]) -= _vals_l[p] * x(j);
+        }
+    }
+    
+    // L^T z = y
+    for (auto j=dim-1; j>=0; j--) {
+        for (auto p=sym.col_ptrs_l[j]+1; p<sym.col_ptrs_l[j+1]; p++) {
+            x(j) -= _vals_l[p] * x(sym.row_idxs_l[p]);
+        }
+        x(j) /= _vals_l[sym.col_ptrs_l[j]];
+    }
+    
+    // P^T z
+    for (auto k=0; k<dim; k++) {
+        vec(sym.perm[k]) = x(k);
+    }
+}
+
+arma::vec SparseCholFactor::solve(const arma::vec &vec) const {
+    arma::vec x = vec;
+    solve_in_place(x);
+    return x;
+}
+
+int SparseCholFactor::_get_l_idx(int i, int j) const {
+    const std::vector<int> &row_idxs_l = _symbolic->row_idxs_l;
+    auto begin = row_idxs_l.begin() + _symbolic->col_ptrs_l[j];
+    auto end = row_idxs_l.begin() + _symbolic->col_ptrs_l[j+1];
+    auto it = std::lower_bound(begin, end, i);
+    if (it == end || *it != i) {
+        return -1;
+    }
+    return it - row_idxs_l.begin();
+}
+
+void SparseCholFactor::get_selected_inv(std::vector<double> &vals) const {
+    assert(_is_pd);
+    const SparseCholSymbolic &sym = *_symbolic;
+    int dim = sym.dim;
+    
+    vals.assign(sym.col_ptrs_l[dim], 0.0);
+    for (auto j=dim-1; j>=0; j--) {
+        int p_diag = sym.col_ptrs_l[j];
+        double l_jj = _vals_l[p_diag];
+        
+        // Z_ij = - 1 / L_jj sum_k Z_ik L_kj over the off-diagonal pattern of col j
+        for (auto p=p_diag+1; p<sym.col_ptrs_l[j+1]; p++) {
+            int i = sym.row_idxs_l[p];
+            double sum = 0.0;
+            for (auto q=p_diag+1; q<sym.col_ptrs_l[j+1]; q++) {
+                int k = sym.row_idxs_l[q];
+                int idx = (i >= k) ? _get_l_idx(i, k) : _get_l_idx(k, i);
+                assert(idx >= 0);
+                sum += vals[idx] * _vals_l[q];
+            }
+            vals[p] = - sum / l_jj;
+        }
+        
+        // Z_jj = 1 / L_jj (1 / L_jj - sum_k Z_kj L_kj)
+        double sum = 0.0;
+        for (auto p=p_diag+1; p<sym.col_ptrs_l[j+1]; p++) {
+            sum += vals[p] * _vals_l[p];
+        }
+        vals[p_diag] = (1.0 / l_jj - sum) / l_jj;
+    }
+}
+
+double SparseCholFactor::get_selected_inv_elem(const std::vector<double> &vals, int i, int j) const {
+    int pi = _symbolic->perm_inv[i];
+    int pj = _symbolic->perm_inv[j];
+    int idx = (pi >= pj) ? _get_l_idx(pi, pj) : _get_l_idx(pj, pi);
+    assert(idx >= 0);
+    return vals[idx];
+}
+
+};
@@ -0,0 +1,270 @@
+//
+/*
+File: thread_pool.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/thread_pool.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <exception>
+
+namespace ginv {
+
+int get_no_threads(int no_threads) {
+    if (no_threads <= 0) {
+        no_threads = std::thread::hardware_concurrency();
+    }
+    return std::max(no_threads, 1);
+}
+
+/// Whether the current thread is running items of a parallel_for, as a pool worker or as the caller
+static thread_local bool _in_parallel_for = false;
+
+/// Sets _in_parallel_for for the lifetime of the guard, restoring the previous value
+struct InParallelForGuard {
+    bool previous;
+    InParallelForGuard() : previous(_in_parallel_for) {
+        _in_parallel_for = true;
+    }
+    ~InParallelForGuard() {
+        _in_parallel_for = previous;
+    }
+};
+
+struct WorkRange {
+    std::mutex mutex;
+    int begin = 0;
+    int end = 0;
+};
+
+/// One parallel_for call, shared by the calling thread and the pool workers that join it
+struct ParallelForJob {
+    const std::function<void(int)> &func;
+    std::vector<WorkRange> ranges;
+    int no_threads;
+    
+    /// No participants so far, including the caller, and no pool workers still running; guarded by the pool mutex
+    int no_joined = 1;
+    int no_running = 0;
+    
+    std::atomic<bool> failed;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    
+    ParallelForJob(int no_items, int no_threads, const std::function<void(int)> &func);
+    
+    /// Work on the items as participant t, starting with range t
+    void run(int t);
+};
+
+ParallelForJob::ParallelForJob(int no_items, int no_threads, const std::function<void(int)> &func) : func(func), ranges(no_threads), no_threads(no_threads), failed(false) {
+    
+    // Contiguous range per participant
+    for (auto t=0; t<no_threads; t++) {
+        ranges[t].begin = (t * no_items) / no_threads;
+        ranges[t].end = ((t+1) * no_items) / no_threads;
+    }
+}
+
+void ParallelForJob::run(int t) {
+    InParallelForGuard guard;
+    WorkRange &own = ranges[t];
+    
+    while (!failed) {
+        
+        // Own range first
+        int item = -1;
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (own.begin < own.end) {
+                item = own.begin++;
+            }
+        }
+        
+        // Steal the back half of the largest other range
+        while (item < 0) {
+            int victim = -1, victim_size = 0;
+            for (auto v=0; v<no_threads; v++) {
+                if (v == t) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(ranges[v].mutex);
+                int size = ranges[v].end - ranges[v].begin;
+                if (size > victim_size) {
+                    victim = v;
+                    victim_size = size;
+                }
+            }
+            if (victim < 0) {
+                return;
+            }
+            
+            int begin = 0, end = 0;
+            {
+                std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+                int size = ranges[victim].end - ranges[victim].begin;
+                if (size <= 0) {
+                    // Taken by someone else in the meantime; look again
+                    continue;
+                }
+                end = ranges[victim].end;
+                begin = end - (size + 1) / 2;
+                ranges[victim].end = begin;
+            }
+            {
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = begin + 1;
+                own.end = end;
+            }
+            item = begin;
+        }
+        
+        try {
+            func(item);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            failed = true;
+        }
+    }
+}
+
+/// Persistent workers that join queued parallel_for jobs
+/// @details Created on first use and grown to the largest no threads requested so far. A job stays queued until it has all its participants or its caller finishes, so ranges of participants that never join are stolen by the others.
+class ThreadPool {
+    
+private:
+    
+    std::mutex _mutex;
+    std::condition_variable _cv_work, _cv_done;
+    std::vector<std::thread> _workers;
+    std::deque<std::shared_ptr<ParallelForJob>> _jobs;
+    bool _stop = false;
+    
+    void _work();
+    
+public:
+    
+    ~ThreadPool();
+    
+    /// Run a job on the calling thread and up to no_threads - 1 workers, and wait for it
+    void run(const std::shared_ptr<ParallelForJob> &job);
+};
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cv_work.notify_all();
+    for (auto &worker: _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::_work() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cv_work.wait(lock, [&] { return _stop || !_jobs.empty(); });
+        if (_stop) {
+            return;
+        }
+        
+        // Join the oldest job; it leaves the queue once full
+        std::shared_ptr<ParallelForJob> job = _jobs.front();
+        int t = job->no_joined++;
+        job->no_running++;
+        if (job->no_joined >= job->no_threads) {
+            _jobs.pop_front();
+        }
+        
+        lock.unlock();
+        job->run(t);
+        lock.lock();
+        
+        job->no_running--;
+        if (job->no_running == 0) {
+            _cv_done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::run(const std::shared_ptr<ParallelForJob> &job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        while ((int)_workers.size() < job->no_threads - 1) {
+            _workers.emplace_back(&ThreadPool::_work, this);
+        }
+        _jobs.push_back(job);
+    }
+    _cv_work.notify_all();
+    
+    job->run(0);
+    
+    // No more joins; wait for the workers that did join, since func lives on the caller's stack
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto it = std::find(_jobs.begin(), _jobs.end(), job);
+    if (it != _jobs.end()) {
+        _jobs.erase(it);
+    }
+    _cv_done.wait(lock, [&] { return job->no_running == 0; });
+}
+
+static ThreadPool& _get_thread_pool() {
+    static ThreadPool thread_pool;
+    return thread_pool;
+}
+
+void parallel_for(int no_items, int no_threads, const std::function<void(int)> &func) {
+    
+    // Nested calls run serially, since the outer call already occupies the threads
+    no_threads = std::min(get_no_threads(no_threads), no_items);
+    if (no_threads <= 1 || _in_parallel_for) {
+        for (auto i=0; i<no_items; i++) {
+            func(i);
+        }
+        return;
+    }
+    
+    std::shared_ptr<ParallelForJob> job = std::make_shared<ParallelForJob>(no_items, no_threads, func);
+    _get_thread_pool().run(job);
+    
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+};
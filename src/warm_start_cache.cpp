@@ -0,0 +1,210 @@
+//
+/*
+File: warm_start_cache.cpp
+Created by: Oliver K. Ernst
+Date: 10/17/26
+
+MIT License
+
+Copyright (c) 2020 Oliver K. Ernst
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "../include/ggm_inversion_bits/warm_start_cache.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace ginv {
+
+WarmStartCache::WarmStartCache() {
+}
+
+WarmStartCache::_Bucket* WarmStartCache::_find_bucket(const CompiledPattern &pattern) {
+    auto it = _buckets.find(pattern.hash);
+    if (it == _buckets.end()) {
+        return nullptr;
+    }
+    for (auto &bucket: it->second) {
+        if (bucket.pattern->check_same(pattern)) {
+            return &bucket;
+        }
+    }
+    return nullptr;
+}
+
+const WarmStartCache::_Bucket* WarmStartCache::_find_bucket(const CompiledPattern &pattern) const {
+    return const_cast<WarmStartCache*>(this)->_find_bucket(pattern);
+}
+
+int WarmStartCache::_build(_Bucket &bucket, std::vector<int> &idxs, int lo, int hi) {
+    if (lo >= hi) {
+        return -1;
+    }
+    
+    // Coordinate of largest spread
+    int no_free = bucket.entries[idxs[lo]].cov_vec_true.n_elem;
+    arma::vec lower = bucket.entries[idxs[lo]].cov_vec_true;
+    arma::vec upper = lower;
+    for (auto k=lo+1; k<hi; k++) {
+        lower = arma::min(lower, bucket.entries[idxs[k]].cov_vec_true);
+        upper = arma::max(upper, bucket.entries[idxs[k]].cov_vec_true);
+    }
+    int split_dim = (no_free > 0) ? (upper - lower).index_max() : 0;
+    
+    // Median along it
+    int mid = lo + (hi - lo) / 2;
+    std::nth_element(idxs.begin() + lo, idxs.begin() + mid, idxs.begin() + hi, [&](int a, int b) {
+        return bucket.entries[a].cov_vec_true(split_dim) < bucket.entries[b].cov_vec_true(split_dim);
+    });
+    
+    _KdNode node;
+    node.entry = idxs[mid];
+    node.split_dim = split_dim;
+    node.split_val = (no_free > 0) ? bucket.entries[idxs[mid]].cov_vec_true(split_dim) : 0.0;
+    int node_idx = bucket.nodes.size();
+    bucket.nodes.push_back(node);
+    
+    int left = _build(bucket, idxs, lo, mid);
+    int right = _build(bucket, idxs, mid + 1, hi);
+    bucket.nodes[node_idx].left = left;
+    bucket.nodes[node_idx].right = right;
+    return node_idx;
+}
+
+void WarmStartCache::_rebuild(_Bucket &bucket) {
+    std::vector<int> idxs(bucket.entries.size());
+    std::iota(idxs.begin(), idxs.end(), 0);
+    bucket.nodes.clear();
+    bucket.nodes.reserve(idxs.size());
+    bucket.root = _build(bucket, idxs, 0, idxs.size());
+    bucket.no_indexed = idxs.size();
+}
+
+void WarmStartCache::_search(const _Bucket &bucket, int node, const arma::vec &cov_vec_true, int &best, double &best_dist_sq) const {
+    if (node < 0) {
+        return;
+    }
+    const _KdNode &kd_node = bucket.nodes[node];
+    
+    double dist_sq = arma::accu(arma::square(bucket.entries[kd_node.entry].cov_vec_true - cov_vec_true));
+    if (dist_sq < best_dist_sq) {
+        best = kd_node.entry;
+        best_dist_sq = dist_sq;
+    }
+    
+    if (cov_vec_true.n_elem == 0) {
+        return;
+    }
+    
+    // Near side first; the far side only if the splitting plane is closer than the best so far
+    double diff = cov_vec_true(kd_node.split_dim) - kd_node.split_val;
+    int near = (diff < 0) ? kd_node.left : kd_node.right;
+    int far = (diff < 0) ? kd_node.right : kd_node.left;
+    _search(bucket, near, cov_vec_true, best, best_dist_sq);
+    if (diff * diff < best_dist_sq) {
+        _search(bucket, far, cov_vec_true, best, best_dist_sq);
+    }
+}
+
+bool WarmStartCache::lookup(const CompiledPattern &pattern, const arma::vec &cov_vec_true, arma::mat &prec_mat, double &dist) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    
+    const _Bucket *bucket = _find_bucket(pattern);
+    if (!bucket || bucket->entries.empty()) {
+        return false;
+    }
+    
+    int best = -1;
+    double best_dist_sq = std::numeric_limits<double>::infinity();
+    _search(*bucket, bucket->root, cov_vec_true, best, best_dist_sq);
+    for (size_t e=bucket->no_indexed; e<bucket->entries.size(); e++) {
+        double dist_sq = arma::accu(arma::square(bucket->entries[e].cov_vec_true - cov_vec_true));
+        if (dist_sq < best_dist_sq) {
+            best = e;
+            best_dist_sq = dist_sq;
+        }
+    }
+    
+    dist = sqrt(best_dist_sq);
+    if (best < 0 || dist > max_dist) {
+        return false;
+    }
+    
+    // Scatter the free elements
+    const arma::vec &prec_vec = bucket->entries[best].prec_vec;
+    prec_mat.zeros(pattern.dim, pattern.dim);
+    for (size_t s=0; s<pattern.free_offsets.size(); s++) {
+        prec_mat(pattern.free_offsets[s]) = prec_vec(s);
+        prec_mat(pattern.free_offsets_trans[s]) = prec_vec(s);
+    }
+    return true;
+}
+
+void WarmStartCache::insert(std::shared_ptr<const CompiledPattern> pattern, const arma::vec &cov_vec_true, const arma::mat &prec_mat) {
+    assert((int)cov_vec_true.n_elem == pattern->get_no_free());
+    if (!prec_mat.is_finite()) {
+        return;
+    }
+    
+    _Entry entry;
+    entry.cov_vec_true = cov_vec_true;
+    entry.prec_vec.set_size(pattern->free_offsets.size());
+    for (size_t s=0; s<pattern->free_offsets.size(); s++) {
+        entry.prec_vec(s) = prec_mat(pattern->free_offsets[s]);
+    }
+    
+    std::lock_guard<std::mutex> lock(_mutex);
+    
+    _Bucket *bucket = _find_bucket(*pattern);
+    if (!bucket) {
+        _buckets[pattern->hash].emplace_back();
+        bucket = &_buckets[pattern->hash].back();
+        bucket->pattern = pattern;
+    }
+    bucket->entries.push_back(std::move(entry));
+    
+    if ((int)bucket->entries.size() > max_no_entries_per_pattern) {
+        // Drop the oldest half
+        bucket->entries.erase(bucket->entries.begin(), bucket->entries.begin() + bucket->entries.size() / 2);
+        _rebuild(*bucket);
+    } else if ((int)bucket->entries.size() - bucket->no_indexed > std::max(16, bucket->no_indexed / 4)) {
+        _rebuild(*bucket);
+    }
+}
+
+int WarmStartCache::get_no_entries() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    
+    int no_entries = 0;
+    for (auto const &pr: _buckets) {
+        for (auto const &bucket: pr.second) {
+            no_entries += bucket.entries.size();
+        }
+    }
+    return no_entries;
+}
+
+void WarmStartCache::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _buckets.clear();
+}
+
+};
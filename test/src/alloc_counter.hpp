@@ -0,0 +1,52 @@
+// Count heap allocations by interposing the glibc allocator; include in a single translation unit per test
+#if defined(__GLIBC__)
+
+#include <atomic>
+#include <cstdlib>
+#include <cerrno>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t no, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+}
+
+static std::atomic<long> no_allocs(0);
+
+extern "C" {
+
+void *malloc(size_t size) __THROW {
+    no_allocs++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t no, size_t size) __THROW {
+    no_allocs++;
+    return __libc_calloc(no, size);
+}
+
+void *realloc(void *ptr, size_t size) __THROW {
+    no_allocs++;
+    return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) __THROW {
+    no_allocs++;
+    *ptr = __libc_memalign(alignment, size);
+    return (*ptr == nullptr && size != 0) ? ENOMEM : 0;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) __THROW {
+    no_allocs++;
+    return __libc_memalign(alignment, size);
+}
+
+void free(void *ptr) __THROW {
+    __libc_free(ptr);
+}
+
+}
+
+#endif
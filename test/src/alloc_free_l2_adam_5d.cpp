@@ -0,0 +1,79 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+#include "alloc_counter.hpp"
+
+using namespace std;
+using namespace ginv;
+
+#if defined(__GLIBC__)
+
+long count_allocs_in_solve(L2OptimizerAdam &opt, int no_opt_steps, const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) {
+    opt.no_opt_steps = no_opt_steps;
+    long no_allocs_start = no_allocs.load();
+    auto pr = opt.solve(cov_mat_true, prec_mat_init);
+    long no_allocs_end = no_allocs.load();
+    return no_allocs_end - no_allocs_start;
+}
+
+#endif
+
+int main() {
+    
+#if defined(__GLIBC__)
+    
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    idx_pairs_free.push_back(std::make_pair(0, 0));
+    idx_pairs_free.push_back(std::make_pair(1, 1));
+    idx_pairs_free.push_back(std::make_pair(2, 2));
+    idx_pairs_free.push_back(std::make_pair(3, 3));
+    idx_pairs_free.push_back(std::make_pair(4, 4));
+
+    idx_pairs_free.push_back(std::make_pair(0, 3));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(2, 4));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+    
+    arma::mat cov_mat_true = {
+        {100, 0, 0, 20, 0},
+        {0, 80, 3, 0, 0},
+        {0, 3, 6, 0, 4},
+        {20, 0, 0, 40, 10},
+        {0, 0, 4, 10, 60}
+    };
+    
+    L2OptimizerAdam opt(5, idx_pairs_free);
+    
+    // Small steps so that no run stops early at the PD boundary
+    arma::mat prec_mat_init = 0.01 * arma::eye(5,5);
+    opt.lr = 1e-6;
+    
+    // Warm up any lazily initialized state in the libraries
+    count_allocs_in_solve(opt, 10, cov_mat_true, prec_mat_init);
+    
+    // Allocations must not grow with the number of steps
+    long no_allocs_short = count_allocs_in_solve(opt, 10, cov_mat_true, prec_mat_init);
+    long no_allocs_long = count_allocs_in_solve(opt, 1000, cov_mat_true, prec_mat_init);
+    
+    std::cout << "Allocations for 10 steps: " << no_allocs_short << " for 1000 steps: " << no_allocs_long << std::endl;
+    
+    if (no_allocs_short != no_allocs_long) {
+        std::cout << "Failed: the optimization loop allocates" << std::endl;
+        return 1;
+    }
+    
+#else
+    
+    std::cout << "Skipped: allocation counting requires glibc" << std::endl;
+    
+#endif
+    
+    return 0;
+}
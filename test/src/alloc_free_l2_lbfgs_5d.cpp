@@ -0,0 +1,125 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+#include "alloc_counter.hpp"
+
+using namespace std;
+using namespace ginv;
+
+#if defined(__GLIBC__)
+
+long count_allocs_in_solve(L2OptimizerLBFGS &opt, int no_opt_steps, const arma::mat &cov_mat_true, const arma::mat &prec_mat_init) {
+    opt.no_opt_steps = no_opt_steps;
+    long no_allocs_start = no_allocs.load();
+    auto pr = opt.solve(cov_mat_true, prec_mat_init);
+    long no_allocs_end = no_allocs.load();
+    return no_allocs_end - no_allocs_start;
+}
+
+#endif
+
+int main() {
+    
+#if defined(__GLIBC__)
+    
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    idx_pairs_free.push_back(std::make_pair(0, 0));
+    idx_pairs_free.push_back(std::make_pair(1, 1));
+    idx_pairs_free.push_back(std::make_pair(2, 2));
+    idx_pairs_free.push_back(std::make_pair(3, 3));
+    idx_pairs_free.push_back(std::make_pair(4, 4));
+
+    idx_pairs_free.push_back(std::make_pair(0, 3));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(2, 4));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+    
+    arma::mat cov_mat_true = {
+        {100, 0, 0, 20, 0},
+        {0, 80, 3, 0, 0},
+        {0, 3, 6, 0, 4},
+        {20, 0, 0, 40, 10},
+        {0, 0, 4, 10, 60}
+    };
+    
+    L2OptimizerLBFGS opt(5, idx_pairs_free);
+    opt.conv_max_abs_deriv = 0.0;
+    arma::mat prec_mat_init = 0.01 * arma::eye(5,5);
+    
+    // Warm up any lazily initialized state in the libraries, and the workspace
+    count_allocs_in_solve(opt, 10, cov_mat_true, prec_mat_init);
+    
+    // Allocations must not grow with the number of steps, and repeated solves only allocate the returned mats
+    long no_allocs_short = count_allocs_in_solve(opt, 10, cov_mat_true, prec_mat_init);
+    long no_allocs_long = count_allocs_in_solve(opt, 1000, cov_mat_true, prec_mat_init);
+    long no_allocs_repeat = count_allocs_in_solve(opt, 10, cov_mat_true, prec_mat_init);
+    
+    std::cout << "Allocations for 10 steps: " << no_allocs_short << " for 1000 steps: " << no_allocs_long << " repeated: " << no_allocs_repeat << std::endl;
+    
+    if (no_allocs_short != no_allocs_long || no_allocs_short != no_allocs_repeat) {
+        std::cout << "Failed: the optimization loop allocates" << std::endl;
+        return 1;
+    }
+    
+    // Two components of different sizes, {0,1,2} and {3,4}, solved in turn on this thread
+    std::vector<std::pair<int,int>> idx_pairs_free_two;
+    for (auto i=0; i<5; i++) {
+        idx_pairs_free_two.push_back(std::make_pair(i, i));
+    }
+    idx_pairs_free_two.push_back(std::make_pair(0, 1));
+    idx_pairs_free_two.push_back(std::make_pair(1, 2));
+    idx_pairs_free_two.push_back(std::make_pair(3, 4));
+    
+    arma::mat cov_mat_true_two = {
+        {100, 10, 0, 0, 0},
+        {10, 80, 3, 0, 0},
+        {0, 3, 6, 0, 0},
+        {0, 0, 0, 40, 10},
+        {0, 0, 0, 10, 60}
+    };
+    
+    L2OptimizerLBFGS opt_two(5, idx_pairs_free_two);
+    opt_two.no_threads_components = 1;
+    opt_two.conv_max_abs_deriv = 0.0;
+    
+    // The first component on its own, with the same sizes
+    std::vector<std::pair<int,int>> idx_pairs_free_first(idx_pairs_free_two.begin(), idx_pairs_free_two.begin() + 3);
+    idx_pairs_free_first.push_back(std::make_pair(0, 1));
+    idx_pairs_free_first.push_back(std::make_pair(1, 2));
+    L2OptimizerLBFGS opt_first(3, idx_pairs_free_first);
+    opt_first.conv_max_abs_deriv = 0.0;
+    arma::mat cov_mat_true_first = cov_mat_true_two.submat(0, 0, 2, 2);
+    
+    count_allocs_in_solve(opt_first, 10, cov_mat_true_first, 0.01 * arma::eye(3,3));
+    count_allocs_in_solve(opt_two, 10, cov_mat_true_two, prec_mat_init);
+    
+    long no_allocs_two_short = count_allocs_in_solve(opt_two, 10, cov_mat_true_two, prec_mat_init);
+    long no_allocs_two_long = count_allocs_in_solve(opt_two, 1000, cov_mat_true_two, prec_mat_init);
+    
+    // The workspace of the first component must survive the solve of the second
+    arma::mat prec_mat_init_first = 0.01 * arma::eye(3,3);
+    long no_allocs_first_after_two = count_allocs_in_solve(opt_first, 10, cov_mat_true_first, prec_mat_init_first);
+    long no_allocs_first_repeat = count_allocs_in_solve(opt_first, 10, cov_mat_true_first, prec_mat_init_first);
+    
+    std::cout << "Two components: allocations for 10 steps: " << no_allocs_two_short << " for 1000 steps: " << no_allocs_two_long << "; first component after both: " << no_allocs_first_after_two << " repeated: " << no_allocs_first_repeat << std::endl;
+    
+    if (no_allocs_two_short != no_allocs_two_long || no_allocs_first_after_two != no_allocs_first_repeat) {
+        std::cout << "Failed: the workspaces of the components are rebuilt" << std::endl;
+        return 1;
+    }
+    
+#else
+    
+    std::cout << "Skipped: allocation counting requires glibc" << std::endl;
+    
+#endif
+    
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // Chain 0 - 1 - 2, clique {2,3,4}, leaf 5 on 4
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    for (auto i=0; i<6; i++) {
+        idx_pairs_free.push_back(std::make_pair(i, i));
+    }
+    idx_pairs_free.push_back(std::make_pair(0, 1));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(2, 3));
+    idx_pairs_free.push_back(std::make_pair(2, 4));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+    idx_pairs_free.push_back(std::make_pair(4, 5));
+
+    arma::mat cov_mat_true = {
+        {50, 10, 0, 0, 0, 0},
+        {10, 40, 8, 0, 0, 0},
+        {0, 8, 30, 5, 6, 0},
+        {0, 0, 5, 20, 4, 0},
+        {0, 0, 6, 4, 25, 7},
+        {0, 0, 0, 0, 7, 35}
+    };
+    
+    AnalyticSolver solver(6, idx_pairs_free);
+    
+    auto pr = solver.solve(cov_mat_true, arma::mat());
+    arma::mat cov_mat_solved = pr.first;
+    arma::mat prec_mat_solved = pr.second;
+
+    std::cout << "Prec mat soln" << std::endl;
+    std::cout << prec_mat_solved << std::endl;
+    
+    std::cout << "Cov mat soln" << std::endl;
+    std::cout << cov_mat_solved << std::endl;
+    
+    // Free elements of the cov mat must match the target, non-free elements of the prec mat must vanish
+    double max_err_cov = arma::abs(solver.free_mat_to_vec(cov_mat_solved - cov_mat_true)).max();
+    double max_err_prec = arma::abs(solver.non_free_mat_to_vec(prec_mat_solved)).max();
+    std::cout << "Max err cov: " << max_err_cov << " prec: " << max_err_prec << std::endl;
+    
+    if (max_err_cov > 1e-8 || max_err_prec > 1e-12) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+    
+    // A 4-cycle is not chordal
+    std::vector<std::pair<int,int>> idx_pairs_free_cycle;
+    for (auto i=0; i<4; i++) {
+        idx_pairs_free_cycle.push_back(std::make_pair(i, i));
+        idx_pairs_free_cycle.push_back(std::make_pair(i, (i+1) % 4));
+    }
+    try {
+        AnalyticSolver solver_cycle(4, idx_pairs_free_cycle);
+        std::cout << "Failed: 4-cycle accepted" << std::endl;
+        return 1;
+    } catch (const std::invalid_argument &e) {
+        std::cout << "4-cycle rejected: " << e.what() << std::endl;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // Prime 4-cycle 0-1-2-3, glued along the free pair (2,3) to the triangle {2,3,4}, glued at 4 to the edge (4,5)
+    std::vector<std::pair<int,int>> idx_pairs_free = get_test_pattern_6d();
+    arma::mat cov_mat_true = get_test_cov_mat_6d();
+    
+    BCDSolver solver(6, idx_pairs_free);
+    solver.decompose_separators = true;
+    solver.options.log_progress = true;
+    solver.options.log_interval = 10;
+    
+    auto pr = solver.solve(cov_mat_true, arma::eye(6,6));
+    arma::mat cov_mat_solved = pr.first;
+    arma::mat prec_mat_solved = pr.second;
+
+    std::cout << "Prec mat soln" << std::endl;
+    std::cout << prec_mat_solved << std::endl;
+    
+    // Same problem without the decomposition
+    solver.decompose_separators = false;
+    auto pr_full = solver.solve(cov_mat_true, arma::eye(6,6));
+    
+    double max_diff_prec = arma::abs(prec_mat_solved - pr_full.second).max();
+    double max_err_cov = arma::abs(solver.free_mat_to_vec(cov_mat_solved - cov_mat_true)).max();
+    double max_err_prec = arma::abs(solver.non_free_mat_to_vec(prec_mat_solved)).max();
+    std::cout << "Max diff to undecomposed prec: " << max_diff_prec << " max err cov: " << max_err_cov << " prec: " << max_err_prec << std::endl;
+    
+    if (max_diff_prec > 1e-8 || max_err_cov > 1e-6 || max_err_prec > 1e-12) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
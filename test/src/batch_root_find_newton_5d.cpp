@@ -0,0 +1,87 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+
+int main() {
+    
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    idx_pairs_free.push_back(std::make_pair(0, 0));
+    idx_pairs_free.push_back(std::make_pair(1, 1));
+    idx_pairs_free.push_back(std::make_pair(2, 2));
+    idx_pairs_free.push_back(std::make_pair(3, 3));
+    idx_pairs_free.push_back(std::make_pair(4, 4));
+    idx_pairs_free.push_back(std::make_pair(0, 3));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(2, 4));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+
+    arma::mat cov_mat_base = {
+        {100, 0, 0, 20, 0},
+        {0, 80, 30, 0, 0},
+        {0, 30, 6, 0, 8},
+        {20, 0, 0, 40, 10},
+        {0, 0, 8, 10, 60}
+    };
+    
+    // Targets perturbed on the free off-diagonal elements
+    int no_targets = 1000;
+    std::vector<arma::mat> cov_mats_true;
+    for (auto i=0; i<no_targets; i++) {
+        arma::mat cov_mat_true = cov_mat_base;
+        for (auto pr: idx_pairs_free) {
+            if (pr.first != pr.second) {
+                double val = cov_mat_base(pr.first, pr.second) * get_random_number(0.9, 1.1);
+                cov_mat_true(pr.first, pr.second) = val;
+                cov_mat_true(pr.second, pr.first) = val;
+            }
+        }
+        cov_mats_true.push_back(cov_mat_true);
+    }
+    
+    RootFindingNewton rfn(5, idx_pairs_free);
+    rfn.conv_max_no_opt_steps = 20;
+    rfn.conv_max_abs_res = 1e-10;
+    rfn.conv_mean_abs_res = 1e-10;
+    arma::mat prec_mat_init = 0.03 * arma::eye(5,5);
+    
+    // Serial
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::pair<arma::mat,arma::mat>> solns_serial;
+    for (auto const &cov_mat_true: cov_mats_true) {
+        solns_serial.push_back(rfn.solve(cov_mat_true, prec_mat_init));
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "Serial: " << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+    
+    // Batch
+    start = std::chrono::steady_clock::now();
+    auto solns_batch = rfn.solve_batch(cov_mats_true, prec_mat_init);
+    end = std::chrono::steady_clock::now();
+    std::cout << "Batch on " << get_no_threads(0) << " threads: " << std::chrono::duration<double>(end - start).count() << " s" << std::endl;
+    
+    // Compare
+    double max_diff = 0.0;
+    for (auto i=0; i<no_targets; i++) {
+        max_diff = std::max(max_diff, arma::abs(solns_serial[i].second - solns_batch[i].second).max());
+    }
+    std::cout << "Max abs diff between serial and batch prec mats: " << max_diff << std::endl;
+    
+    if (max_diff > 1e-12) {
+        std::cout << "FAILED" << std::endl;
+        return 1;
+    }
+    
+    std::cout << "OK" << std::endl;
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+
+int main() {
+    
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    idx_pairs_free.push_back(std::make_pair(0, 0));
+    idx_pairs_free.push_back(std::make_pair(1, 1));
+    idx_pairs_free.push_back(std::make_pair(2, 2));
+    idx_pairs_free.push_back(std::make_pair(3, 3));
+    idx_pairs_free.push_back(std::make_pair(4, 4));
+    idx_pairs_free.push_back(std::make_pair(0, 3));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(2, 4));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+
+    arma::mat cov_mat_true = {
+        {100, 0, 0, 20, 0},
+        {0, 80, 3, 0, 0},
+        {0, 3, 6, 0, 4},
+        {20, 0, 0, 40, 10},
+        {0, 0, 4, 10, 60}
+    };
+    
+    BCDSolver bcd(5, idx_pairs_free);
+    
+    arma::mat prec_mat_init = arma::eye(5,5);
+    bcd.options.log_progress = true;
+    bcd.options.log_interval = 1;
+    bcd.options.write_interval = 1;
+    bcd.options.write_progress = true;
+    bcd.options.write_dir = "../output/bcd_5d/data/";
+    ensure_dir_exists(bcd.options.write_dir);
+    auto pr = bcd.solve(cov_mat_true, prec_mat_init);
+    arma::mat cov_mat_solved = pr.first;
+    arma::mat prec_mat_solved = pr.second;
+
+    std::cout << "Solved:" << std::endl;
+    std::cout << "Prec mat:" << std::endl;
+    std::cout << prec_mat_solved << std::endl;
+    std::cout << "Cov mat:" << std::endl;
+    std::cout << cov_mat_solved << std::endl;
+    std::cout << "Inverse(Prec mat):" << std::endl;
+    std::cout << arma::inv(prec_mat_solved) << std::endl;
+    
+    // Free elements of the cov mat must match the target, non-free elements of the prec mat must vanish
+    double max_err_cov = arma::abs(bcd.free_mat_to_vec(cov_mat_solved - cov_mat_true)).max();
+    double max_err_prec = arma::abs(bcd.non_free_mat_to_vec(prec_mat_solved)).max();
+    double max_err_inv = arma::abs(arma::inv(prec_mat_solved) - cov_mat_solved).max();
+    std::cout << "Max err cov: " << max_err_cov << " prec: " << max_err_prec << " inverse: " << max_err_inv << std::endl;
+    
+    if (max_err_cov > 1e-6 || max_err_prec > 1e-10 || max_err_inv > 1e-6) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -10,6 +10,34 @@
 using namespace std;
 using namespace ginv;
 
+/// Free pairs of the 6d test pattern: the 4-cycle 0-1-2-3 with the triangle {2,3,4} and the edge (4,5), all diagonal elements free
+std::vector<std::pair<int,int>> get_test_pattern_6d() {
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    for (auto i=0; i<6; i++) {
+        idx_pairs_free.push_back(std::make_pair(i, i));
+    }
+    idx_pairs_free.push_back(std::make_pair(0, 1));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(2, 3));
+    idx_pairs_free.push_back(std::make_pair(0, 3));
+    idx_pairs_free.push_back(std::make_pair(2, 4));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+    idx_pairs_free.push_back(std::make_pair(4, 5));
+    return idx_pairs_free;
+}
+
+/// Target cov mat for the 6d test pattern
+arma::mat get_test_cov_mat_6d() {
+    return {
+        {50, 10, 0, 6, 0, 0},
+        {10, 40, 8, 0, 0, 0},
+        {0, 8, 30, 5, 6, 0},
+        {6, 0, 5, 20, 4, 0},
+        {0, 0, 6, 4, 25, 7},
+        {0, 0, 0, 0, 7, 35}
+    };
+}
+
 void report_results(
                     const arma::mat &prec_mat_solved,
                     const arma::mat &cov_mat_true,
@@ -0,0 +1,63 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // Components {0,1,2}, {3,4,5} and the single element {6}
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    for (auto i=0; i<7; i++) {
+        idx_pairs_free.push_back(std::make_pair(i, i));
+    }
+    idx_pairs_free.push_back(std::make_pair(0, 1));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+    idx_pairs_free.push_back(std::make_pair(4, 5));
+    idx_pairs_free.push_back(std::make_pair(3, 5));
+
+    arma::mat cov_mat_true = {
+        {50, 10, 0, 0, 0, 0, 0},
+        {10, 40, 8, 0, 0, 0, 0},
+        {0, 8, 30, 0, 0, 0, 0},
+        {0, 0, 0, 20, 4, 3, 0},
+        {0, 0, 0, 4, 25, 7, 0},
+        {0, 0, 0, 3, 7, 35, 0},
+        {0, 0, 0, 0, 0, 0, 15}
+    };
+    
+    BCDSolver solver(7, idx_pairs_free);
+    solver.options.log_progress = true;
+    solver.options.log_interval = 1;
+    
+    auto pr = solver.solve(cov_mat_true, arma::eye(7,7));
+    arma::mat cov_mat_solved = pr.first;
+    arma::mat prec_mat_solved = pr.second;
+
+    std::cout << "Prec mat soln" << std::endl;
+    std::cout << prec_mat_solved << std::endl;
+    
+    // Same problem without the decomposition
+    solver.decompose_components = false;
+    auto pr_full = solver.solve(cov_mat_true, arma::eye(7,7));
+    
+    double max_diff_prec = arma::abs(prec_mat_solved - pr_full.second).max();
+    double max_err_cov = arma::abs(solver.free_mat_to_vec(cov_mat_solved - cov_mat_true)).max();
+    double max_err_prec = arma::abs(solver.non_free_mat_to_vec(prec_mat_solved)).max();
+    std::cout << "Max diff to undecomposed prec: " << max_diff_prec << " max err cov: " << max_err_cov << " prec: " << max_err_prec << std::endl;
+    
+    if (max_diff_prec > 1e-8 || max_err_cov > 1e-6 || max_err_prec > 0) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
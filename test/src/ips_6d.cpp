@@ -0,0 +1,48 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // 4-cycle 0-1-2-3 with the triangle {2,3,4} and the edge (4,5)
+    std::vector<std::pair<int,int>> idx_pairs_free = get_test_pattern_6d();
+    arma::mat cov_mat_true = get_test_cov_mat_6d();
+    
+    // Whole pattern, so that IPS runs on all cliques
+    IPSSolver solver(6, idx_pairs_free);
+    solver.decompose_separators = false;
+    solver.options.log_progress = true;
+    solver.options.log_interval = 10;
+    
+    // Poor initial guess
+    auto pr = solver.solve(cov_mat_true, 100.0 * arma::eye(6,6));
+    arma::mat cov_mat_solved = pr.first;
+    arma::mat prec_mat_solved = pr.second;
+
+    std::cout << "Prec mat soln" << std::endl;
+    std::cout << prec_mat_solved << std::endl;
+    
+    std::cout << "Cov mat soln" << std::endl;
+    std::cout << cov_mat_solved << std::endl;
+    
+    double max_err_cov = arma::abs(solver.free_mat_to_vec(cov_mat_solved - cov_mat_true)).max();
+    double max_err_prec = arma::abs(solver.non_free_mat_to_vec(prec_mat_solved)).max();
+    double max_err_inv = arma::abs(arma::inv(prec_mat_solved) - cov_mat_solved).max();
+    std::cout << "Max err cov: " << max_err_cov << " prec: " << max_err_prec << " inverse: " << max_err_inv << std::endl;
+    
+    if (max_err_cov > 1e-6 || max_err_prec > 0 || max_err_inv > 1e-6) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+
+double check_deriv_equivalence(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free) {
+    
+    // Random PD prec mat and target
+    arma::mat a = arma::randu(dim, dim);
+    arma::mat prec_mat_curr = a * a.t() + dim * arma::eye(dim, dim);
+    arma::mat cov_mat_curr = arma::inv(prec_mat_curr);
+    
+    arma::mat b = arma::randu(dim, dim);
+    arma::mat cov_mat_true = b * b.t() + dim * arma::eye(dim, dim);
+    
+    L2OptimizerGD opt(dim, idx_pairs_free);
+    arma::mat derivs = opt.get_deriv_mat(cov_mat_curr, cov_mat_true);
+    arma::mat derivs_ref = opt.get_deriv_mat_reference(cov_mat_curr, cov_mat_true);
+    
+    double max_diff = arma::abs(derivs - derivs_ref).max();
+    double max_ref = arma::abs(derivs_ref).max();
+    
+    std::cout << "Dim: " << dim << " no free: " << idx_pairs_free.size() << " max abs diff: " << max_diff << " max abs deriv: " << max_ref << std::endl;
+    
+    return max_diff / max_ref;
+}
+
+double check_hessian_vec_prod_equivalence(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free) {
+    
+    arma::mat a = arma::randu(dim, dim);
+    arma::mat prec_mat_curr = a * a.t() + dim * arma::eye(dim, dim);
+    arma::mat cov_mat_curr = arma::inv(prec_mat_curr);
+    
+    arma::mat b = arma::randu(dim, dim);
+    arma::mat cov_mat_true = b * b.t() + dim * arma::eye(dim, dim);
+    
+    arma::vec vec = arma::randu(idx_pairs_free.size());
+    
+    L2OptimizerGD opt(dim, idx_pairs_free);
+    arma::vec prod = opt.get_hessian_vec_prod(cov_mat_curr, cov_mat_true, vec);
+    arma::vec prod_ref = opt.get_hessian(cov_mat_curr, cov_mat_true) * vec;
+    
+    double max_diff = arma::abs(prod - prod_ref).max();
+    double max_ref = arma::abs(prod_ref).max();
+    
+    std::cout << "Dim: " << dim << " no free: " << idx_pairs_free.size() << " max abs diff in Hessian-vector product: " << max_diff << " max abs entry: " << max_ref << std::endl;
+    
+    return max_diff / max_ref;
+}
+
+double check_res_jacobian_equivalence(int dim, const std::vector<std::pair<int,int>> &idx_pairs_free) {
+    
+    arma::mat a = arma::randu(dim, dim);
+    arma::mat prec_mat_curr = a * a.t() + dim * arma::eye(dim, dim);
+    arma::mat cov_mat_curr = arma::inv(prec_mat_curr);
+    
+    arma::mat b = arma::randu(dim, dim);
+    arma::mat cov_mat_true = b * b.t() + dim * arma::eye(dim, dim);
+    
+    arma::vec vec = arma::randu(idx_pairs_free.size());
+    
+    L2OptimizerGD opt(dim, idx_pairs_free);
+    arma::mat jacobian = opt.get_res_jacobian(cov_mat_curr);
+    arma::vec res_vec = opt.free_mat_to_vec(cov_mat_curr - cov_mat_true);
+    
+    // J v and J^T v matrix-free, and the derivs as 2 J^T r
+    double rel_diff = arma::abs(opt.get_res_jacobian_vec_prod(cov_mat_curr, vec) - jacobian * vec).max() / arma::abs(jacobian * vec).max();
+    rel_diff = std::max(rel_diff, arma::abs(opt.get_res_jacobian_trans_vec_prod(cov_mat_curr, vec) - jacobian.t() * vec).max() / arma::abs(jacobian.t() * vec).max());
+    arma::vec deriv_vec = opt.get_deriv_vec(cov_mat_curr, cov_mat_true);
+    rel_diff = std::max(rel_diff, arma::abs(2.0 * jacobian.t() * res_vec - deriv_vec).max() / arma::abs(deriv_vec).max());
+    
+    std::cout << "Dim: " << dim << " no free: " << idx_pairs_free.size() << " max rel diff in residual Jacobian products: " << rel_diff << std::endl;
+    
+    return rel_diff;
+}
+
+int main() {
+    
+    arma::arma_rng::set_seed(42);
+    
+    // 5D pattern from the other tests
+    std::vector<std::pair<int,int>> idx_pairs_free_5d;
+    idx_pairs_free_5d.push_back(std::make_pair(0, 0));
+    idx_pairs_free_5d.push_back(std::make_pair(1, 1));
+    idx_pairs_free_5d.push_back(std::make_pair(2, 2));
+    idx_pairs_free_5d.push_back(std::make_pair(3, 3));
+    idx_pairs_free_5d.push_back(std::make_pair(4, 4));
+    idx_pairs_free_5d.push_back(std::make_pair(0, 3));
+    idx_pairs_free_5d.push_back(std::make_pair(1, 2));
+    idx_pairs_free_5d.push_back(std::make_pair(2, 4));
+    idx_pairs_free_5d.push_back(std::make_pair(3, 4));
+    
+    // Random 20D pattern, including pairs given in lower-triangular order
+    int dim = 20;
+    std::vector<std::pair<int,int>> idx_pairs_free_20d;
+    for (auto i=0; i<dim; i++) {
+        idx_pairs_free_20d.push_back(std::make_pair(i, i));
+        for (auto j=i+1; j<dim; j++) {
+            if (get_random_number(0.0, 1.0) < 0.2) {
+                if (get_random_number(0.0, 1.0) < 0.5) {
+                    idx_pairs_free_20d.push_back(std::make_pair(i, j));
+                } else {
+                    idx_pairs_free_20d.push_back(std::make_pair(j, i));
+                }
+            }
+        }
+    }
+    
+    double rel_diff = std::max(check_deriv_equivalence(5, idx_pairs_free_5d), check_deriv_equivalence(dim, idx_pairs_free_20d));
+    rel_diff = std::max(rel_diff, check_hessian_vec_prod_equivalence(5, idx_pairs_free_5d));
+    rel_diff = std::max(rel_diff, check_hessian_vec_prod_equivalence(dim, idx_pairs_free_20d));
+    rel_diff = std::max(rel_diff, check_res_jacobian_equivalence(5, idx_pairs_free_5d));
+    rel_diff = std::max(rel_diff, check_res_jacobian_equivalence(dim, idx_pairs_free_20d));
+    if (rel_diff > 1e-10) {
+        std::cout << "FAILED: relative difference: " << rel_diff << std::endl;
+        return 1;
+    }
+    
+    std::cout << "OK" << std::endl;
+    return 0;
+}
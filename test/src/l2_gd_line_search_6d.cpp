@@ -0,0 +1,49 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // 4-cycle 0-1-2-3 with the triangle {2,3,4} and the edge (4,5)
+    std::vector<std::pair<int,int>> idx_pairs_free = get_test_pattern_6d();
+    arma::mat cov_mat_true = get_test_cov_mat_6d();
+    arma::mat prec_mat_init = arma::diagmat(1.0 / cov_mat_true.diag());
+    
+    // No tuning of lr: a far too large first step is backtracked, with or without the curvature condition
+    bool failed = false;
+    for (auto line_search: {"armijo", "wolfe"}) {
+        L2OptimizerGD opt(6, idx_pairs_free);
+        opt.decompose_separators = false;
+        opt.line_search = line_search;
+        opt.lr = 1e3;
+        opt.no_opt_steps = 1000;
+        opt.options.log_progress = true;
+        opt.options.log_interval = 100;
+        
+        auto pr = opt.solve(cov_mat_true, prec_mat_init);
+        double obj_func_init = opt.get_obj_func_val(arma::inv(prec_mat_init), cov_mat_true);
+        double obj_func = opt.get_obj_func_val(pr.first, cov_mat_true);
+        bool is_pd = pr.second.is_sympd();
+        std::cout << line_search << ": obj func init: " << obj_func_init << " final: " << obj_func << " PD: " << is_pd << std::endl;
+        
+        if (!is_pd || !(obj_func < 0.1 * obj_func_init)) {
+            failed = true;
+        }
+    }
+    
+    if (failed) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+
+int main() {
+    
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    idx_pairs_free.push_back(std::make_pair(0, 0));
+    idx_pairs_free.push_back(std::make_pair(1, 1));
+    idx_pairs_free.push_back(std::make_pair(2, 2));
+    idx_pairs_free.push_back(std::make_pair(3, 3));
+    idx_pairs_free.push_back(std::make_pair(4, 4));
+
+    idx_pairs_free.push_back(std::make_pair(0, 3));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(2, 4));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+
+    arma::mat cov_mat_true = {
+        {100, 0, 0, 20, 0},
+        {0, 80, 3, 0, 0},
+        {0, 3, 6, 0, 4},
+        {20, 0, 0, 40, 10},
+        {0, 0, 4, 10, 60}
+    };
+    
+    arma::mat prec_mat_init = 0.01 * arma::eye(5,5);
+    
+    // With J^T J formed
+    L2OptimizerLM opt(5, idx_pairs_free);
+    opt.decompose_separators = false;
+    opt.no_opt_steps = 100;
+    opt.options.log_progress = true;
+    opt.options.log_interval = 1;
+    auto pr = opt.solve(cov_mat_true, prec_mat_init);
+    arma::mat prec_mat_solved = pr.second;
+    
+    report_results(prec_mat_solved, cov_mat_true, idx_pairs_free, opt);
+    
+    // With CG on products with J and J^T
+    L2OptimizerLM opt_mat_free(5, idx_pairs_free);
+    opt_mat_free.decompose_separators = false;
+    opt_mat_free.no_opt_steps = 100;
+    opt_mat_free.max_no_free_dense = 0;
+    auto pr_mat_free = opt_mat_free.solve(cov_mat_true, prec_mat_init);
+    arma::mat prec_mat_solved_mat_free = pr_mat_free.second;
+    
+    double obj_func = opt.get_obj_func_val(pr.first, cov_mat_true);
+    double obj_func_mat_free = opt_mat_free.get_obj_func_val(pr_mat_free.first, cov_mat_true);
+    double max_diff = arma::abs(prec_mat_solved - prec_mat_solved_mat_free).max();
+    std::cout << "Obj func with J^T J: " << obj_func << " with products: " << obj_func_mat_free << " max abs diff in prec mat: " << max_diff << std::endl;
+    
+    if (obj_func > 1e-12 || obj_func_mat_free > 1e-12 || max_diff > 1e-8) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+
+int main() {
+    
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    idx_pairs_free.push_back(std::make_pair(0, 0));
+    idx_pairs_free.push_back(std::make_pair(1, 1));
+    idx_pairs_free.push_back(std::make_pair(2, 2));
+    idx_pairs_free.push_back(std::make_pair(3, 3));
+    idx_pairs_free.push_back(std::make_pair(4, 4));
+
+    idx_pairs_free.push_back(std::make_pair(0, 3));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(2, 4));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+
+    arma::mat cov_mat_true = {
+        {100, 0, 0, 20, 0},
+        {0, 80, 3, 0, 0},
+        {0, 3, 6, 0, 4},
+        {20, 0, 0, 40, 10},
+        {0, 0, 4, 10, 60}
+    };
+    
+    L2OptimizerNewtonCG opt(5, idx_pairs_free);
+    
+    arma::mat prec_mat_init = 0.01 * arma::eye(5,5);
+    opt.no_opt_steps = 100;
+    opt.options.write_interval = 1;
+    opt.options.write_progress = true;
+    opt.options.write_dir = "../output/l2_newton_cg_5d/data/";
+    ensure_dir_exists(opt.options.write_dir);
+    auto pr = opt.solve(cov_mat_true, prec_mat_init);
+    arma::mat prec_mat_solved = pr.second;
+    
+    report_results(prec_mat_solved, cov_mat_true, idx_pairs_free, opt);
+    
+    double max_err_cov = arma::abs(opt.free_mat_to_vec(pr.first - cov_mat_true)).max();
+    std::cout << "Max err cov: " << max_err_cov << std::endl;
+    
+    if (max_err_cov > 1e-6 || !prec_mat_solved.is_sympd()) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
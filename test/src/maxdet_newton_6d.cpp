@@ -0,0 +1,45 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // 4-cycle 0-1-2-3 with the triangle {2,3,4} and the edge (4,5)
+    std::vector<std::pair<int,int>> idx_pairs_free = get_test_pattern_6d();
+    arma::mat cov_mat_true = get_test_cov_mat_6d();
+    
+    // Whole pattern, so that Newton runs on the full problem
+    MaxDetNewton solver(6, idx_pairs_free);
+    solver.decompose_separators = false;
+    solver.options.log_progress = true;
+    
+    auto pr = solver.solve(cov_mat_true, arma::mat());
+    arma::mat cov_mat_solved = pr.first;
+    arma::mat prec_mat_solved = pr.second;
+
+    std::cout << "Prec mat soln" << std::endl;
+    std::cout << prec_mat_solved << std::endl;
+    
+    std::cout << "Cov mat soln" << std::endl;
+    std::cout << cov_mat_solved << std::endl;
+    
+    double max_err_cov = arma::abs(solver.free_mat_to_vec(cov_mat_solved - cov_mat_true)).max();
+    double max_err_prec = arma::abs(solver.non_free_mat_to_vec(prec_mat_solved)).max();
+    std::cout << "Max err cov: " << max_err_cov << " prec: " << max_err_prec << std::endl;
+    
+    if (max_err_cov > 1e-6 || max_err_prec > 0) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
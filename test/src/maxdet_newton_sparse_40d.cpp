@@ -0,0 +1,73 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // Ring of 40 nodes with two chords; prime, so solve() would not split it either
+    int dim = 40;
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    for (auto i=0; i<dim; i++) {
+        idx_pairs_free.push_back(std::make_pair(i, i));
+        idx_pairs_free.push_back(std::make_pair(i, (i+1) % dim));
+    }
+    idx_pairs_free.push_back(std::make_pair(0, 20));
+    idx_pairs_free.push_back(std::make_pair(10, 30));
+    
+    // Target cov mat from a known prec mat with the pattern
+    MaxDetNewton solver(dim, idx_pairs_free);
+    solver.options.log_progress = true;
+    
+    arma::vec prec_vec_true(solver.get_pattern()->get_no_free());
+    for (auto s=0; s<solver.get_pattern()->get_no_free(); s++) {
+        prec_vec_true(s) = (solver.get_pattern()->free_rows[s] == solver.get_pattern()->free_cols[s]) ? 4.0 : -1.0;
+    }
+    arma::mat prec_mat_true = solver.free_vec_to_mat(prec_vec_true);
+    arma::mat cov_mat_true = arma::inv_sympd(prec_mat_true);
+    
+    // Only the free elements of the target are passed
+    arma::sp_mat cov_sp_mat_true = solver.free_vec_to_sp_mat(solver.free_mat_to_vec(cov_mat_true));
+    
+    auto pr = solver.solve_sparse(cov_sp_mat_true, arma::sp_mat());
+    arma::sp_mat cov_sp_mat_solved = pr.first;
+    arma::sp_mat prec_sp_mat_solved = pr.second;
+    
+    std::cout << "Prec mat soln: " << prec_sp_mat_solved.n_nonzero << " nonzeros of " << dim * dim << std::endl;
+    
+    // Compare to the known prec mat, and to the dense path
+    auto pr_dense = solver.solve(cov_mat_true, arma::mat());
+    
+    double max_err_cov = arma::abs(solver.free_sp_mat_to_vec(cov_sp_mat_solved) - solver.free_mat_to_vec(cov_mat_true)).max();
+    double max_err_prec = arma::abs(solver.free_sp_mat_to_vec(prec_sp_mat_solved) - prec_vec_true).max();
+    double max_diff_dense = arma::abs(solver.free_sp_mat_to_vec(prec_sp_mat_solved) - solver.free_mat_to_vec(pr_dense.second)).max();
+    std::cout << "Max err cov: " << max_err_cov << " prec: " << max_err_prec << " diff to dense: " << max_diff_dense << std::endl;
+    
+    // Selected inverse against the dense inverse
+    SparseCholFactor chol_factor;
+    chol_factor.analyze(*solver.get_pattern());
+    chol_factor.factorize(prec_sp_mat_solved);
+    arma::mat cov_mat_dense = arma::inv_sympd(arma::mat(prec_sp_mat_solved));
+    double max_err_selected_inv = arma::abs(solver.get_cov_vec(chol_factor) - solver.free_mat_to_vec(cov_mat_dense)).max();
+    std::cout << "Max err selected inv: " << max_err_selected_inv << std::endl;
+    
+    // The symbolic analysis is built once for the pattern and shared with copies of the solver
+    MaxDetNewton solver_copy(solver);
+    bool shared = solver_copy.get_pattern()->get_sparse_chol_symbolic() == solver.get_pattern()->get_sparse_chol_symbolic();
+    std::cout << "Symbolic analysis shared: " << shared << std::endl;
+    
+    if (!shared || max_err_selected_inv > 1e-10 || max_err_cov > 1e-6 || max_err_prec > 1e-4 || max_diff_dense > 1e-4) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // 4-cycle 0-1-2-3 with the triangle {2,3,4} and the edge (4,5)
+    std::vector<std::pair<int,int>> idx_pairs_free = get_test_pattern_6d();
+
+    // Strong correlations, far from the diagonal: all correlations 0.8
+    arma::vec vars = {50, 40, 30, 20, 25, 35};
+    arma::vec sds = arma::sqrt(vars);
+    arma::mat cov_mat_true = 0.8 * sds * sds.t() + 0.2 * arma::diagmat(vars);
+    
+    // Whole pattern, so that the continuation runs on the full problem
+    RootFindingContinuation solver(6, idx_pairs_free);
+    solver.decompose_separators = false;
+    solver.conv_max_abs_res = 1e-8;
+    solver.conv_mean_abs_res = 1e-8;
+    solver.options.log_progress = true;
+    
+    // No initial guess is needed
+    auto pr = solver.solve(cov_mat_true, arma::mat());
+    arma::mat cov_mat_solved = pr.first;
+    arma::mat prec_mat_solved = pr.second;
+
+    std::cout << "Prec mat soln" << std::endl;
+    std::cout << prec_mat_solved << std::endl;
+    
+    std::cout << "Cov mat soln" << std::endl;
+    std::cout << cov_mat_solved << std::endl;
+    
+    double max_err_cov = arma::abs(solver.free_mat_to_vec(cov_mat_solved - cov_mat_true)).max();
+    double max_err_prec = arma::abs(solver.non_free_mat_to_vec(prec_mat_solved)).max();
+    double max_err_inv = arma::abs(arma::inv(prec_mat_solved) - cov_mat_solved).max();
+    std::cout << "Max err cov: " << max_err_cov << " prec: " << max_err_prec << " inverse: " << max_err_inv << std::endl;
+    
+    if (max_err_cov > 1e-6 || max_err_prec > 1e-10 || max_err_inv > 1e-4) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
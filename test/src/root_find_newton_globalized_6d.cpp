@@ -0,0 +1,52 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // 4-cycle 0-1-2-3 with the triangle {2,3,4} and the edge (4,5)
+    std::vector<std::pair<int,int>> idx_pairs_free = get_test_pattern_6d();
+    arma::mat cov_mat_true = get_test_cov_mat_6d();
+    // Cheap init as for the L2 solvers, far from the solution
+    arma::mat prec_mat_init = 0.01 * arma::eye(6,6);
+    
+    // Whole pattern, so that the non-free elements of Sigma are unknowns too
+    for (auto use_jacobian_free: {false, true}) {
+        RootFindingNewton rfn(6, idx_pairs_free);
+        rfn.decompose_separators = false;
+        rfn.globalized = true;
+        rfn.use_jacobian_free = use_jacobian_free;
+        rfn.conv_max_abs_res = 1e-10;
+        rfn.conv_mean_abs_res = 1e-10;
+        rfn.conv_max_no_opt_steps = 100;
+        rfn.options.log_progress = true;
+        rfn.options.log_interval = 1;
+        
+        auto pr = rfn.solve(cov_mat_true, prec_mat_init);
+        arma::mat cov_mat_solved = pr.first;
+        arma::mat prec_mat_solved = pr.second;
+        
+        std::cout << "Prec mat soln" << std::endl;
+        std::cout << prec_mat_solved << std::endl;
+        
+        double max_abs_res = arma::abs(rfn.get_residuals(prec_mat_solved, cov_mat_solved)).max();
+        double max_err_cov = arma::abs(rfn.free_mat_to_vec(cov_mat_solved - cov_mat_true)).max();
+        std::cout << "Jacobian-free: " << use_jacobian_free << " max abs residual: " << max_abs_res << " max err cov: " << max_err_cov << std::endl;
+        
+        if (max_abs_res > 1e-10 || max_err_cov > 1e-8 || !prec_mat_solved.is_sympd()) {
+            std::cout << "Failed" << std::endl;
+            return 1;
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // 4-cycle 0-1-2-3 with the triangle {2,3,4} and the edge (4,5)
+    std::vector<std::pair<int,int>> idx_pairs_free = get_test_pattern_6d();
+    arma::mat cov_mat_true = get_test_cov_mat_6d();
+    arma::mat prec_mat_init = arma::diagmat(1.0 / cov_mat_true.diag());
+    
+    // Whole pattern, so that the non-free elements of Sigma are unknowns too
+    long no_factorizations_always = 0;
+    for (auto jacobian_refresh: {"always", "shamanskii", "broyden"}) {
+        RootFindingNewton rfn(6, idx_pairs_free);
+        rfn.stats = std::make_shared<RootFindingNewtonStats>();
+        rfn.decompose_separators = false;
+        rfn.globalized = true;
+        rfn.jacobian_refresh = jacobian_refresh;
+        rfn.conv_max_abs_res = 1e-10;
+        rfn.conv_mean_abs_res = 1e-10;
+        rfn.conv_max_no_opt_steps = 100;
+        rfn.options.log_progress = true;
+        rfn.options.log_interval = 1;
+        
+        auto pr = rfn.solve(cov_mat_true, prec_mat_init);
+        arma::mat cov_mat_solved = pr.first;
+        arma::mat prec_mat_solved = pr.second;
+        
+        std::cout << "Prec mat soln" << std::endl;
+        std::cout << prec_mat_solved << std::endl;
+        
+        double max_abs_res = arma::abs(rfn.get_residuals(prec_mat_solved, cov_mat_solved)).max();
+        double max_err_cov = arma::abs(rfn.free_mat_to_vec(cov_mat_solved - cov_mat_true)).max();
+        long no_factorizations = rfn.stats->no_jacobian_factorizations;
+        std::cout << "Jacobian refresh: " << jacobian_refresh << " max abs residual: " << max_abs_res << " max err cov: " << max_err_cov << " steps: " << rfn.stats->no_opt_steps << " factorizations: " << no_factorizations << std::endl;
+        
+        if (max_abs_res > 1e-10 || max_err_cov > 1e-8 || !prec_mat_solved.is_sympd()) {
+            std::cout << "Failed" << std::endl;
+            return 1;
+        }
+        
+        // Reuse must actually skip factorizations
+        if (std::string(jacobian_refresh) == "always") {
+            no_factorizations_always = no_factorizations;
+        } else if (no_factorizations >= no_factorizations_always) {
+            std::cout << "Failed: no fewer factorizations than refreshing at every step" << std::endl;
+            return 1;
+        }
+    }
+    
+    return 0;
+}
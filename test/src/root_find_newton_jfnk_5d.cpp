@@ -0,0 +1,72 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+
+int main() {
+    
+    std::vector<std::pair<int,int>> idx_pairs_free;
+    idx_pairs_free.push_back(std::make_pair(0, 0));
+    idx_pairs_free.push_back(std::make_pair(1, 1));
+    idx_pairs_free.push_back(std::make_pair(2, 2));
+    idx_pairs_free.push_back(std::make_pair(3, 3));
+    idx_pairs_free.push_back(std::make_pair(4, 4));
+    idx_pairs_free.push_back(std::make_pair(0, 3));
+    idx_pairs_free.push_back(std::make_pair(1, 2));
+    idx_pairs_free.push_back(std::make_pair(2, 4));
+    idx_pairs_free.push_back(std::make_pair(3, 4));
+
+    // PD target, so that a PD solution exists
+    arma::mat cov_mat_true = {
+        {100, 0, 0, 20, 0},
+        {0, 80, 3, 0, 0},
+        {0, 3, 6, 0, 4},
+        {20, 0, 0, 40, 10},
+        {0, 0, 4, 10, 60}
+    };
+    
+    RootFindingNewton rfn(5, idx_pairs_free);
+    
+    arma::mat prec_mat_init = arma::diagmat(1.0 / cov_mat_true.diag());
+    rfn.conv_max_no_opt_steps = 30;
+    
+    // Only the max residual decides convergence
+    rfn.conv_max_abs_res = 1e-8;
+    rfn.conv_mean_abs_res = 0.0;
+    rfn.use_jacobian_free = true;
+    rfn.options.log_progress = true;
+    rfn.options.log_interval = 1;
+    rfn.options.log_mats = true;
+    auto pr = rfn.solve(cov_mat_true, prec_mat_init);
+    arma::mat cov_mat_solved = pr.first;
+    arma::mat prec_mat_solved = pr.second;
+
+    std::cout << "Solved:" << std::endl;
+    std::cout << "Prec mat:" << std::endl;
+    std::cout << prec_mat_solved << std::endl;
+    std::cout << "Inverse(Prec mat):" << std::endl;
+    std::cout << arma::inv(prec_mat_solved) << std::endl;
+    std::cout << "Cov mat:" << std::endl;
+    std::cout << cov_mat_solved << std::endl;
+    std::cout << "Inverse(Cov mat):" << std::endl;
+    std::cout << arma::inv(cov_mat_solved) << std::endl;
+    
+    double max_abs_res = arma::abs(rfn.get_residuals(prec_mat_solved, cov_mat_solved)).max();
+    std::cout << "Max abs residual: " << max_abs_res << std::endl;
+    
+    if (max_abs_res > rfn.conv_max_abs_res) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <ggm_inversion>
+
+#include "spdlog/spdlog.h"
+#include <exception>
+#include <armadillo>
+
+#include "common.hpp"
+
+using namespace std;
+using namespace ginv;
+int main() {
+    
+    // 4-cycle 0-1-2-3 with the triangle {2,3,4} and the edge (4,5)
+    std::vector<std::pair<int,int>> idx_pairs_free = get_test_pattern_6d();
+    std::shared_ptr<const CompiledPattern> pattern = compile_pattern(6, idx_pairs_free);
+    int no_free = pattern->get_no_free();
+    
+    // Nearest neighbour through the k-d tree against a linear scan; entry e is tagged by prec_mat(0,0) = e
+    arma::arma_rng::set_seed(1);
+    WarmStartCache cache;
+    std::vector<arma::vec> cov_vecs;
+    for (auto e=0; e<300; e++) {
+        cov_vecs.push_back(arma::randu(no_free));
+        cache.insert(pattern, cov_vecs.back(), e * arma::eye(6,6));
+    }
+    int no_wrong = 0;
+    for (auto q=0; q<100; q++) {
+        arma::vec cov_vec = arma::randu(no_free);
+        
+        int best = 0;
+        for (size_t e=1; e<cov_vecs.size(); e++) {
+            if (arma::norm(cov_vecs[e] - cov_vec) < arma::norm(cov_vecs[best] - cov_vec)) {
+                best = e;
+            }
+        }
+        
+        arma::mat prec_mat;
+        double dist;
+        if (!cache.lookup(*pattern, cov_vec, prec_mat, dist) || (int)prec_mat(0,0) != best) {
+            no_wrong++;
+        }
+    }
+    std::cout << "Wrong nearest neighbours: " << no_wrong << " of 100" << std::endl;
+    
+    // Another pattern is not matched
+    arma::mat prec_mat;
+    double dist;
+    bool other_matched = cache.lookup(*compile_pattern(6, std::vector<std::pair<int,int>>(idx_pairs_free.begin(), idx_pairs_free.end() - 1)), arma::randu(no_free - 1), prec_mat, dist);
+    std::cout << "Other pattern matched: " << other_matched << std::endl;
+    
+    // Solve a target, then a nearby one from the cached solution
+    arma::mat cov_mat_true = get_test_cov_mat_6d();
+    IPSSolver solver(pattern);
+    solver.options.log_progress = true;
+    solver.warm_start_cache = std::make_shared<WarmStartCache>();
+    
+    solver.solve(cov_mat_true, arma::mat());
+    arma::mat cov_mat_near = cov_mat_true;
+    cov_mat_near(0,1) = cov_mat_near(1,0) = 10.5;
+    auto pr = solver.solve(cov_mat_near, arma::mat());
+    
+    double max_err_cov = arma::abs(solver.free_mat_to_vec(pr.first - cov_mat_near)).max();
+    std::cout << "Cache entries: " << solver.warm_start_cache->get_no_entries() << " max err cov: " << max_err_cov << std::endl;
+    
+    if (no_wrong > 0 || other_matched || solver.warm_start_cache->get_no_entries() != 2 || max_err_cov > 1e-6) {
+        std::cout << "Failed" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}